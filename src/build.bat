@@ -1,7 +1,7 @@
 @echo off
 
 set CommonCompilerFlags=-wd4505 -MT -nologo -Gm- -GR- -EHa- -Od -Oi -WX -W4 -wd4201 -wd4100 -wd4189 -FC -Z7 -DGOL_DEBUG=1
-set CommonLinkerFlags= -opt:ref user32.lib gdi32.lib
+set CommonLinkerFlags= -opt:ref user32.lib gdi32.lib advapi32.lib
 
 IF NOT EXIST w:\game_of_life\build mkdir w:\game_of_life\build
 pushd w:\game_of_life\build
@@ -10,5 +10,11 @@ REM 32-bit build
 REM cl %CommonCompilerFlags% ..\handmade\code\win32_handmade.cpp /link -subsystem:windows,5.1 %CommonLinkerFlags%
 
 REM 64-bit build
-cl %CommonCompilerFlags% ..\src\win32_life.cpp /link %CommonLinkerFlags%
+REM libgol, the engine behind the C API in gol.h: gol.lib to link statically,
+REM gol_shared.dll (and its import library) for anything loading it at run time
+cl %CommonCompilerFlags% -c ..\src\gol.cpp -Fogol.obj
+lib -nologo gol.obj -out:gol.lib
+cl %CommonCompilerFlags% -DGOL_SHARED -DGOL_EXPORTS -LD ..\src\gol.cpp -Fogol_shared.obj -Fegol_shared.dll /link -opt:ref advapi32.lib
+
+cl %CommonCompilerFlags% ..\src\win32_life.cpp /link %CommonLinkerFlags% gol.lib
 popd
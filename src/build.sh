@@ -0,0 +1,16 @@
+#!/bin/sh
+
+CommonCompilerFlags="-O2 -g -mpopcnt -fno-rtti -fno-exceptions -Wall -Werror -Wno-unused-function -Wno-unused-variable -Wno-unused-but-set-variable -DGOL_DEBUG=1"
+CommonLinkerFlags="-lpthread"
+
+cd "$(dirname "$0")"
+mkdir -p ../build
+cd ../build
+
+# libgol, the engine behind the C API in gol.h: static, and shared for
+# anything loading it at run time
+g++ $CommonCompilerFlags -fPIC -c ../src/gol.cpp -o gol.o
+ar rcs libgol.a gol.o
+g++ $CommonCompilerFlags -fPIC -fvisibility=hidden -DGOL_SHARED -DGOL_EXPORTS -shared ../src/gol.cpp -o libgol.so $CommonLinkerFlags
+
+g++ $CommonCompilerFlags ../src/linux_life.cpp -o linux_life $CommonLinkerFlags
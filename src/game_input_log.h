@@ -0,0 +1,201 @@
+#ifndef GAME_INPUT_LOG_H
+
+// NOTE(ian): Input logs, so a session at the window can be played back
+// exactly, headless, as often as we like. The game only ever sees its input,
+// so the same input from the same fresh board is the same session, frame
+// for frame.
+//
+// A log is a game_input_log_header, then rule_size bytes of rule text, then
+// frames until the file ends. Each frame is coded against the one before it
+// (the first against an input that's all zero):
+//     u8      game_input_log_flags: what changed
+//     varint  mouse_x and mouse_y deltas, zigzagged   (Game_Input_Log_Mouse)
+//     u8      one bit per button_states entry         (Game_Input_Log_Buttons)
+//     f32     animation_speed_factor                  (Game_Input_Log_Speed)
+//     varint  scaling_factor                          (Game_Input_Log_Scaling)
+// so a frame where nothing happened is one byte. A log cut short (the window
+// crashed, say) still plays back up to its last whole frame.
+
+#define GAME_INPUT_LOG_MAGIC 0x4C504E49 // "INPL"
+#define GAME_INPUT_LOG_VERSION 1
+#define GAME_INPUT_LOG_MAX_FRAME_SIZE 32
+
+enum game_input_log_flags
+{
+    Game_Input_Log_Mouse = 0x1,
+    Game_Input_Log_Buttons = 0x2,
+    Game_Input_Log_Speed = 0x4,
+    Game_Input_Log_Scaling = 0x8,
+};
+
+struct game_input_log_header
+{
+    u32 magic;
+    u32 version;
+    u32 rule_size;   // NOTE(ian): 0 for the default rule
+    u32 old_buttons; // NOTE(ian): the frame before the first, since the game
+                     // compares each frame's buttons with the last one's
+};
+
+inline u8 *
+write_input_varint(u8 *out, u32 value)
+{
+    while(value >= 0x80)
+    {
+        *out++ = (u8)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (u8)value;
+    return(out);
+}
+
+inline u8 *
+read_input_varint(u8 *in, u8 *end, u32 *value)
+{
+    u32 result = 0;
+    u32 shift = 0;
+    while(in < end && shift < 32)
+    {
+        u8 byte = *in++;
+        result |= (u32)(byte & 0x7F) << shift;
+        shift += 7;
+        if(!(byte & 0x80))
+        {
+            *value = result;
+            return(in);
+        }
+    }
+    return(0);
+}
+
+// NOTE(ian): Mouse deltas are small either way, so fold the sign into the
+// low bit to keep them one byte.
+inline u32
+zigzag_encode(s32 value)
+{
+    u32 result = ((u32)value << 1) ^ (u32)(value >> 31);
+    return(result);
+}
+
+inline s32
+zigzag_decode(u32 value)
+{
+    s32 result = (s32)(value >> 1) ^ -(s32)(value & 1);
+    return(result);
+}
+
+// NOTE(ian): The platforms store whatever their key state APIs hand back in
+// the buttons, not just 1, so only whether they're set is kept.
+inline u32
+get_input_buttons(game_input *input)
+{
+    u32 result = 0;
+    for(u32 button = 0;
+        button < Array_Count(input->button_states);
+        button += 1)
+    {
+        if(input->button_states[button])
+        {
+            result |= 1 << button;
+        }
+    }
+    return(result);
+}
+
+inline void
+set_input_buttons(game_input *input, u32 buttons)
+{
+    for(u32 button = 0;
+        button < Array_Count(input->button_states);
+        button += 1)
+    {
+        input->button_states[button] = (buttons >> button) & 1;
+    }
+}
+
+// NOTE(ian): Writes at most GAME_INPUT_LOG_MAX_FRAME_SIZE bytes and returns
+// the end of them.
+internal u8 *
+encode_input_frame(u8 *out, game_input *input, game_input *previous)
+{
+    u8 *flags = out++;
+    *flags = 0;
+    if(input->mouse_x != previous->mouse_x || input->mouse_y != previous->mouse_y)
+    {
+        *flags |= Game_Input_Log_Mouse;
+        out = write_input_varint(out, zigzag_encode(input->mouse_x - previous->mouse_x));
+        out = write_input_varint(out, zigzag_encode(input->mouse_y - previous->mouse_y));
+    }
+    u32 buttons = get_input_buttons(input);
+    if(buttons != get_input_buttons(previous))
+    {
+        *flags |= Game_Input_Log_Buttons;
+        *out++ = (u8)buttons;
+    }
+    if(input->animation_speed_factor != previous->animation_speed_factor)
+    {
+        *flags |= Game_Input_Log_Speed;
+        memcpy(out, &input->animation_speed_factor, sizeof(f32));
+        out += sizeof(f32);
+    }
+    if(input->scaling_factor != previous->scaling_factor)
+    {
+        *flags |= Game_Input_Log_Scaling;
+        out = write_input_varint(out, input->scaling_factor);
+    }
+    return(out);
+}
+
+// NOTE(ian): input holds the previous frame and comes back as this one.
+// Returns the start of the next frame, or 0 if the log ends partway
+// through this one.
+internal u8 *
+decode_input_frame(u8 *in, u8 *end, game_input *input)
+{
+    if(in >= end)
+    {
+        return(0);
+    }
+
+    u8 flags = *in++;
+    if(in && (flags & Game_Input_Log_Mouse))
+    {
+        u32 delta_x = 0;
+        u32 delta_y = 0;
+        in = read_input_varint(in, end, &delta_x);
+        in = in ? read_input_varint(in, end, &delta_y) : 0;
+        input->mouse_x += zigzag_decode(delta_x);
+        input->mouse_y += zigzag_decode(delta_y);
+    }
+    if(in && (flags & Game_Input_Log_Buttons))
+    {
+        if(in < end)
+        {
+            set_input_buttons(input, *in++);
+        }
+        else
+        {
+            in = 0;
+        }
+    }
+    if(in && (flags & Game_Input_Log_Speed))
+    {
+        if(end - in >= (s64)sizeof(f32))
+        {
+            memcpy(&input->animation_speed_factor, in, sizeof(f32));
+            in += sizeof(f32);
+        }
+        else
+        {
+            in = 0;
+        }
+    }
+    if(in && (flags & Game_Input_Log_Scaling))
+    {
+        in = read_input_varint(in, end, &input->scaling_factor);
+    }
+    return(in);
+}
+
+#define GAME_INPUT_LOG_H
+#endif
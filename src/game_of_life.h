@@ -1,8 +1,411 @@
 #ifndef GAME_OF_LIFE_H
 
+// NOTE(ian): The game itself: the little board you click cells into and
+// watch run. It only knows the engine through libgol (gol.h), like any other
+// client.
 
+struct game_memory
+{
+    bool32 is_initialized; // NOTE(ian): clear it to start over on a fresh board
 
+    // NOTE(ian): Optional rule in any notation gol_create_board takes;
+    // Conway's when it's null or doesn't parse.
+    char *rule;
+};
 
+struct game_input
+{
+    f32 animation_speed_factor;
+    u32 scaling_factor;
+    int mouse_x;
+    int mouse_y;
+    union
+    {
+        bool32 button_states[8];
+        struct
+        {
+            bool32 mouse_left;
+            bool32 mouse_right;
+
+            bool32 up;
+            bool32 down;
+            bool32 left;
+            bool32 right;
+
+            bool32 run_simulation;
+            bool32 reset;
+        };
+    };
+};
+
+internal void draw_rectangle(game_graphics_buffer *buffer,
+                             int min_x, int min_y, int max_x, int max_y,
+                             color rect_color)
+{
+    // TODO(ian): mathematically round these values instead of truncating them...
+    u32 red   = u32(rect_color.r * 255.0f);
+    u32 green = u32(rect_color.g * 255.0f);
+    u32 blue  = u32(rect_color.b * 255.0f);
+
+    u32 pixel_color = ((red << 16) | (green << 8) | blue);
+
+    if(min_x < 0)
+    {
+        min_x = 0;
+    }
+    if(min_y < 0)
+    {
+        min_y = 0;
+    }
+    if(max_x >= buffer->width)
+    {
+        max_x = buffer->width;
+    }
+    if(max_y >= buffer->height)
+    {
+        max_y = buffer->height;
+    }
+
+    u8 *row = ((u8 *)buffer->memory +
+                     min_y*buffer->bytes_per_row +
+                     min_x*buffer->bytes_per_pixel);
+    for(int y = min_y;
+        y < max_y;
+        y += 1)
+    {
+        u32 *pixel = (u32 *)row;
+        for(int x = min_x;
+            x < max_x;
+            x += 1)
+        {
+            *pixel++ = pixel_color;
+        }
+        row += buffer->bytes_per_row;
+    }
+}
+
+// TODO(ian): user should be able to control the rows, columns, and
+// grid scaling...
+#define GRID_ROWS 36
+#define GRID_COLUMNS 64
+
+// NOTE(ian): The step itself simulates every cell, treating everything past
+// the edge as dead. The window has always kept its outermost ring of tiles as
+// a dead border, so we clear it again after each generation.
+internal void
+clear_board_border(gol_board *board)
+{
+    for(u32 col = 0;
+        col < GRID_COLUMNS;
+        col += 1)
+    {
+        gol_set_cell_state(board, 0, col, 0);
+        gol_set_cell_state(board, GRID_ROWS - 1, col, 0);
+    }
+    for(u32 row = 0;
+        row < GRID_ROWS;
+        row += 1)
+    {
+        gol_set_cell_state(board, row, 0, 0);
+        gol_set_cell_state(board, row, GRID_COLUMNS - 1, 0);
+    }
+}
+
+// NOTE(ian): Dying states fade from dying_color towards off_color as they
+// age, so Generations patterns show which way they're moving.
+internal color
+get_state_color(u32 state, u32 state_count,
+                color on_color, color off_color, color dying_color)
+{
+    color result = off_color;
+    if(state == 1)
+    {
+        result = on_color;
+    }
+    else if(state > 1)
+    {
+        f32 t = (f32)(state - 2) / (f32)(state_count - 1);
+        result.r = dying_color.r + t*(off_color.r - dying_color.r);
+        result.g = dying_color.g + t*(off_color.g - dying_color.g);
+        result.b = dying_color.b + t*(off_color.b - dying_color.b);
+    }
+    return(result);
+}
+
+internal void
+game_update_and_render(game_graphics_buffer *buffer,
+                       game_memory *memory,
+                       game_input new_input,
+                       game_input old_input)
+{
+#if 1
+    // DRAW A WEIRD GRADIENT FOR DEBUG PURPOSES
+    {
+        local_persist u8 blue_offset  = 0;
+        local_persist u8 green_offset = 0;
+        {
+            u32 *pixel = (u32 *)buffer->memory;
+            for(int y = 0;
+                y < buffer->height;
+                y += 1)
+            {
+                for(int x = 0;
+                    x < buffer->width;
+                    x += 1)
+                {
+                    u8 blue = (u8)y + blue_offset;
+                    u8 green = (u8)x + green_offset;
+                    u8 red = (u8)(blue + green);
+
+                    *pixel++ = ((red << 16) | (green << 8) | blue);
+                }
+            }
+        }
+    }
+#endif
+
+    local_persist gol_board *board = 0;
+    if(!memory->is_initialized)
+    {
+        gol_destroy_board(board);
+        if(gol_create_board(GRID_ROWS, GRID_COLUMNS, memory->rule, &board) != GOL_OK)
+        {
+            gol_create_board(GRID_ROWS, GRID_COLUMNS, 0, &board);
+        }
+        memory->is_initialized = true;
+    }
+    gol_board_info board_info;
+    gol_get_board_info(board, &board_info);
+
+    int tile_top_x = 0;
+    int tile_top_y = 0;
+    int tile_side_in_pixels = 15;
+    int tile_side_in_meters = 1;
+    int tile_pad = 1;
+
+    color tile_border_color = {0.5f, 0.5f, 0.5f};
+    color tile_off_color = {1.0f, 1.0f, 1.0f};
+    color tile_on_color = {0.0f, 0.0f, 0.0f};
+    color tile_dying_color = {0.2f, 0.4f, 0.9f};
+    color grid_border_color = {0.25f, 0.25f, 0.25f};
+
+    if(!new_input.run_simulation)
+    {
+        if(new_input.mouse_left)
+        {
+            local_persist bool32 toggle_on;
+            local_persist int prev_tile_x;
+            local_persist int prev_tile_y;
+
+            int cur_tile_x = (new_input.mouse_x / tile_side_in_pixels) / new_input.scaling_factor;
+            int cur_tile_y = (new_input.mouse_y / tile_side_in_pixels) / new_input.scaling_factor;
+
+            if((0 <= cur_tile_x && cur_tile_x < GRID_COLUMNS) &&
+               (0 <= cur_tile_y && cur_tile_y < GRID_ROWS))
+            {
+                // NOTE(ian): Here, we check for a simple mouse-click,
+                // as in a situation where the user is just trying to toggle
+                // tiles.
+                if(new_input.mouse_left != old_input.mouse_left)
+                {
+                    toggle_on = (gol_get_cell_state(board, cur_tile_y, cur_tile_x) != 1);
+                    gol_set_cell_state(board, cur_tile_y, cur_tile_x, toggle_on ? 1 : 0);
+                }
+                // NOTE(ian): Here, we held the mouse mouse button down and dragged.
+                // We check that the current tile is different from the previous one
+                // so that we can check a situation where the user is trying to
+                // "paint" the tiles.
+                //
+                // In that case, we paint tiles based on what we previously clicked.
+                // E.g., if the user previously clicked an off-tile, then they will
+                // paint with on-tiles, and if they previously clicked an on-tile,
+                // they will paint with off-tiles.
+                else
+                {
+                    if (cur_tile_x != prev_tile_x ||
+                         cur_tile_y != prev_tile_y)
+                    {
+                        gol_set_cell_state(board, cur_tile_y, cur_tile_x, toggle_on ? 1 : 0);
+                    }
+                }
+
+            }
+            prev_tile_x = cur_tile_x;
+            prev_tile_y = cur_tile_y;
+        }
+    }
+    else
+    {
+        gol_step_board(board, 1);
+        clear_board_border(board);
+    }
+
+    // DRAW_GRID
+    {
+        for(int row = 0;
+            row < GRID_ROWS;
+            row += 1)
+        {
+            for(int col = 0;
+                col < GRID_COLUMNS;
+                col += 1)
+            {
+                // draw outer rect
+
+                draw_rectangle(buffer,
+                               tile_top_x, tile_top_y,
+                               tile_top_x + tile_side_in_pixels,
+                               tile_top_y + tile_side_in_pixels,
+                               tile_border_color);
+                // draw inner rect
+                u32 state = gol_get_cell_state(board, row, col);
+                if(state)
+                {
+                    draw_rectangle(buffer,
+                                   tile_top_x + tile_pad, tile_top_y + tile_pad,
+                                   tile_top_x + tile_side_in_pixels - tile_pad,
+                                   tile_top_y + tile_side_in_pixels - tile_pad,
+                                   get_state_color(state, board_info.state_count,
+                                                   tile_on_color, tile_off_color,
+                                                   tile_dying_color));
+                }
+                else if(row == 0 || row == (GRID_ROWS - 1) ||
+                        col == 0 || col == (GRID_COLUMNS - 1))
+                {
+                    draw_rectangle(buffer,
+                                   tile_top_x + tile_pad, tile_top_y + tile_pad,
+                                   tile_top_x + tile_side_in_pixels - tile_pad,
+                                   tile_top_y + tile_side_in_pixels - tile_pad,
+                                   grid_border_color);
+                }
+                else
+                {
+                    draw_rectangle(buffer,
+                                   tile_top_x + tile_pad, tile_top_y + tile_pad,
+                                   tile_top_x + tile_side_in_pixels - tile_pad,
+                                   tile_top_y + tile_side_in_pixels - tile_pad,
+                                   tile_off_color);
+                }
+                tile_top_x += tile_side_in_pixels;
+            }
+            tile_top_x = 0;
+            tile_top_y += tile_side_in_pixels;
+        }
+    }
+#if 0
+    // DRAW MOUSE:
+    // Construct a square centered on the cursor position.
+    {
+        color mouse_left_color = {1.0f, 0.0f, 0.0f};
+        color mouse_right_color = {0.0f, 0.0f, 1.0f};
+
+        int mouse_tile_side_in_pixels = 50;
+        int mouse_tile_side_in_meters = 1;
+        f32 meters_to_pixels = (f32)mouse_tile_side_in_pixels / (f32)mouse_tile_side_in_meters;
+
+        int mouse_min_x = (new_input.mouse_x - (int)((f32)mouse_tile_side_in_meters * meters_to_pixels / 2)) / new_input.scaling_factor;
+        int mouse_min_y = (new_input.mouse_y - (int)((f32)mouse_tile_side_in_meters * meters_to_pixels / 2)) / new_input.scaling_factor;
+        int mouse_max_x = (new_input.mouse_x + (int)((f32)mouse_tile_side_in_meters * meters_to_pixels / 2)) / new_input.scaling_factor;
+        int mouse_max_y = (new_input.mouse_y + (int)((f32)mouse_tile_side_in_meters * meters_to_pixels / 2)) / new_input.scaling_factor;
+        if(true)
+        {
+            draw_rectangle(buffer,
+                           mouse_min_x, mouse_min_y,
+                           mouse_max_x, mouse_max_y,
+                           mouse_left_color);
+        }
+        if(new_input.mouse_left)
+        {
+            color click_color_1 = {0.0f, 1.0f, 0.0f};
+            draw_rectangle(buffer,
+                           mouse_min_x, mouse_min_y,
+                           mouse_max_x, mouse_max_y,
+                           click_color_1);
+
+            color click_color_2 = {0.0f, 0.0f, 1.0f};
+            draw_rectangle(buffer,
+                           new_input.mouse_x, new_input.mouse_y,
+                           new_input.mouse_x + mouse_tile_side_in_pixels,
+                           new_input.mouse_y + mouse_tile_side_in_pixels,
+                           click_color_2);
+        }
+        if(new_input.mouse_right)
+        {
+
+            draw_rectangle(buffer,
+                           mouse_min_x, mouse_min_y,
+                           mouse_max_x, mouse_max_y,
+                           mouse_right_color);
+        }
+    }
+#endif
+
+#if 0
+    local_persist int player_min_x = 0;
+    local_persist int player_min_y = 0;
+
+    f32 delta_player_x = 0.0f;
+    f32 delta_player_y = 0.0f;
+    f32 player_speed = 1.0f;
+
+    if(new_input.up)
+    {
+        delta_player_y = -1.0f;
+    }
+    if(new_input.down)
+    {
+        delta_player_y = 1.0f;
+    }
+    if(new_input.right)
+    {
+        delta_player_x = 1.0f;
+    }
+    if(new_input.left)
+    {
+        delta_player_x = -1.0f;
+    }
+
+    int player_width = 40;
+    int player_height = 40;
+
+    player_min_x += (int)(delta_player_x * player_speed);
+    player_min_y += (int)(delta_player_y * player_speed);
+    int player_max_x = player_min_x + player_width;
+    int player_max_y = player_min_y + player_height;
+
+    // DRAW PLAYER
+    {
+        color player_color = {0.0f, 1.0f, 0.0f};
+        draw_rectangle(buffer,
+                       player_min_x, player_min_y,
+                       player_max_x, player_max_y,
+                       player_color);
+    }
+#endif
+    // blue_offset += 1;
+    // green_offset += 1;
+}
+
+// NOTE(ian): One frame the way every platform runs it. The game compares this
+// frame's buttons with the last one's, so only those carry over; an input log
+// replays the same calls, so keep anything else that feeds the game in here.
+internal void
+game_run_frame(game_graphics_buffer *buffer, game_memory *memory,
+               game_input *new_input, game_input *old_input)
+{
+    if(new_input->reset)
+    {
+        memory->is_initialized = false;
+    }
+    game_update_and_render(buffer, memory, *new_input, *old_input);
+
+    for(u32 i = 0;
+        i < Array_Count(new_input->button_states);
+        i += 1)
+    {
+        old_input->button_states[i] = new_input->button_states[i];
+    }
+}
 
 #define GAME_OF_LIFE_H
 #endif
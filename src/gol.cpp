@@ -0,0 +1,547 @@
+// NOTE(ian): libgol: the engine built on its own behind the C API in gol.h.
+// It's the whole engine, same code the platform layers compile in, plus a
+// default platform of its own: memory from the OS in reserve-and-commit
+// blocks, and stepping on the calling thread until someone hands it workers.
+// linux_life builds this straight in instead and keeps its own platform.
+
+#include "life.h"
+#include "gol.h"
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+// NOTE(ian): The block header lives at the start of the reservation, and base
+// starts on the next cache line after it, so the header page is always the
+// first thing we commit.
+#define WIN32_BLOCK_HEADER_SIZE ((sizeof(platform_memory_block) + 63) & ~63)
+#define WIN32_COMMIT_GRANULARITY Kilobytes(64)
+
+global_variable SIZE_T global_large_page_size;
+
+internal void
+win32_enable_large_pages(void)
+{
+    // NOTE(ian): MEM_LARGE_PAGES only works if the user has been granted
+    // "Lock pages in memory" (SeLockMemoryPrivilege) and we switch it on for
+    // our token. If any of this fails we just stay on 4KB pages.
+    HANDLE token;
+    if(OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES|TOKEN_QUERY, &token))
+    {
+        TOKEN_PRIVILEGES privileges = {};
+        privileges.PrivilegeCount = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        if(LookupPrivilegeValueA(0, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid))
+        {
+            AdjustTokenPrivileges(token, FALSE, &privileges, 0, 0, 0);
+            if(GetLastError() == ERROR_SUCCESS)
+            {
+                global_large_page_size = GetLargePageMinimum();
+            }
+        }
+        CloseHandle(token);
+    }
+}
+
+internal
+PLATFORM_ALLOCATE_MEMORY(win32_allocate_memory)
+{
+    u64 total_size = size + WIN32_BLOCK_HEADER_SIZE;
+    u8 *memory = 0;
+    u64 committed = 0;
+
+    if((flags & Platform_Memory_Huge_Pages) && global_large_page_size)
+    {
+        // NOTE(ian): Large pages can't be committed lazily, so the whole
+        // block is committed (and locked) right away.
+        total_size = (total_size + global_large_page_size - 1) & ~((u64)global_large_page_size - 1);
+        memory = (u8 *)VirtualAlloc(0, (SIZE_T)total_size,
+                                    MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES,
+                                    PAGE_READWRITE);
+        committed = total_size;
+    }
+
+    if(!memory)
+    {
+        total_size = (total_size + WIN32_COMMIT_GRANULARITY - 1) & ~(WIN32_COMMIT_GRANULARITY - 1);
+        memory = (u8 *)VirtualAlloc(0, (SIZE_T)total_size, MEM_RESERVE, PAGE_READWRITE);
+        if(memory &&
+           !VirtualAlloc(memory, WIN32_COMMIT_GRANULARITY, MEM_COMMIT, PAGE_READWRITE))
+        {
+            VirtualFree(memory, 0, MEM_RELEASE);
+            memory = 0;
+        }
+        committed = WIN32_COMMIT_GRANULARITY;
+    }
+
+    platform_memory_block *block = 0;
+    if(memory)
+    {
+        block = (platform_memory_block *)memory;
+        block->flags = flags;
+        block->base = memory + WIN32_BLOCK_HEADER_SIZE;
+        block->size = total_size - WIN32_BLOCK_HEADER_SIZE;
+        block->committed = committed - WIN32_BLOCK_HEADER_SIZE;
+        block->used = 0;
+        block->prev = 0;
+    }
+    return(block);
+}
+
+internal
+PLATFORM_COMMIT_MEMORY(win32_commit_memory)
+{
+    bool32 result = true;
+    if(size > block->committed)
+    {
+        u64 commit_end = (WIN32_BLOCK_HEADER_SIZE + size + WIN32_COMMIT_GRANULARITY - 1) &
+                         ~(WIN32_COMMIT_GRANULARITY - 1);
+        if(commit_end > block->size + WIN32_BLOCK_HEADER_SIZE)
+        {
+            commit_end = block->size + WIN32_BLOCK_HEADER_SIZE;
+        }
+        u64 commit_start = block->committed + WIN32_BLOCK_HEADER_SIZE;
+
+        u8 *memory = (u8 *)block;
+        if(VirtualAlloc(memory + commit_start, (SIZE_T)(commit_end - commit_start),
+                        MEM_COMMIT, PAGE_READWRITE))
+        {
+            block->committed = commit_end - WIN32_BLOCK_HEADER_SIZE;
+        }
+        else
+        {
+            result = false;
+        }
+    }
+    return(result);
+}
+
+internal
+PLATFORM_DEALLOCATE_MEMORY(win32_deallocate_memory)
+{
+    if(block)
+    {
+        VirtualFree(block, 0, MEM_RELEASE);
+    }
+}
+
+#else
+#include <sys/mman.h>
+
+// NOTE(ian): Same layout as the Win32 blocks. The mapping is MAP_NORESERVE
+// and the kernel only backs pages as they're touched, so the whole block
+// counts as committed from the start.
+#define POSIX_BLOCK_HEADER_SIZE ((sizeof(platform_memory_block) + 63) & ~63)
+
+internal
+PLATFORM_ALLOCATE_MEMORY(posix_allocate_memory)
+{
+    u64 total_size = size + POSIX_BLOCK_HEADER_SIZE;
+    u8 *memory = (u8 *)mmap(0, total_size, PROT_READ|PROT_WRITE,
+                            MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+
+    platform_memory_block *block = 0;
+    if(memory != (u8 *)MAP_FAILED)
+    {
+#ifdef MADV_HUGEPAGE
+        if(flags & Platform_Memory_Huge_Pages)
+        {
+            madvise(memory, total_size, MADV_HUGEPAGE);
+        }
+#endif
+        block = (platform_memory_block *)memory;
+        block->flags = flags;
+        block->base = memory + POSIX_BLOCK_HEADER_SIZE;
+        block->size = size;
+        block->committed = size;
+        block->used = 0;
+        block->prev = 0;
+    }
+    return(block);
+}
+
+internal
+PLATFORM_COMMIT_MEMORY(posix_commit_memory)
+{
+    return(true);
+}
+
+internal
+PLATFORM_DEALLOCATE_MEMORY(posix_deallocate_memory)
+{
+    if(block)
+    {
+        munmap(block, block->size + POSIX_BLOCK_HEADER_SIZE);
+    }
+}
+#endif
+
+struct gol_board
+{
+    memory_arena arena;         // NOTE(ian): the board, this struct included
+    memory_arena scratch_arena; // NOTE(ian): tile buffers for blocked steps
+    life_board board;
+    bool32 stats_stale;         // NOTE(ian): cells were set since the last count
+};
+
+// NOTE(ian): Boards are created and destroyed on any thread.
+global_variable volatile s32 global_board_count;
+
+inline void
+gol_add_board_count(s32 delta)
+{
+#ifdef _WIN32
+    InterlockedExchangeAdd((volatile LONG *)&global_board_count, delta);
+#else
+    __atomic_add_fetch(&global_board_count, delta, __ATOMIC_ACQ_REL);
+#endif
+}
+
+internal
+PLATFORM_RUN_ON_WORKERS(gol_run_serially)
+{
+    callback(0, data);
+}
+
+// NOTE(ian): Anything the platform layer we're built into already set up
+// stays as it is.
+internal void
+gol_initialize_platform(void)
+{
+    if(!global_platform.allocate_memory)
+    {
+#ifdef _WIN32
+        win32_enable_large_pages();
+        global_platform.allocate_memory = win32_allocate_memory;
+        global_platform.commit_memory = win32_commit_memory;
+        global_platform.deallocate_memory = win32_deallocate_memory;
+#else
+        global_platform.allocate_memory = posix_allocate_memory;
+        global_platform.commit_memory = posix_commit_memory;
+        global_platform.deallocate_memory = posix_deallocate_memory;
+#endif
+    }
+    if(!global_platform.run_on_workers)
+    {
+        global_platform.worker_count = 1;
+        global_platform.run_on_workers = gol_run_serially;
+    }
+}
+
+internal FILE *
+gol_open_file(const char *path, const char *mode)
+{
+    FILE *result = 0;
+#ifdef _MSC_VER
+    if(fopen_s(&result, path, mode) != 0)
+    {
+        result = 0;
+    }
+#else
+    result = fopen(path, mode);
+#endif
+    return(result);
+}
+
+GOL_API uint32_t
+gol_get_version(void)
+{
+    return(GOL_VERSION);
+}
+
+GOL_API const char *
+gol_get_result_string(gol_result result)
+{
+    const char *string = "unknown error";
+    switch(result)
+    {
+        case GOL_OK: string = "ok"; break;
+        case GOL_INVALID_ARGUMENT: string = "invalid argument"; break;
+        case GOL_INVALID_RULE: string = "rule doesn't parse"; break;
+        case GOL_OUT_OF_MEMORY: string = "out of memory"; break;
+        case GOL_FILE_ERROR: string = "couldn't read or write the file"; break;
+        case GOL_INVALID_FILE: string = "not a grid file"; break;
+    }
+    return(string);
+}
+
+GOL_API gol_result
+gol_set_workers(uint32_t worker_count, gol_run_on_workers *run_on_workers)
+{
+    if(global_board_count)
+    {
+        return(GOL_INVALID_ARGUMENT);
+    }
+
+    if(worker_count && run_on_workers)
+    {
+        global_platform.worker_count = worker_count;
+        global_platform.run_on_workers = run_on_workers;
+    }
+    else
+    {
+        global_platform.worker_count = 1;
+        global_platform.run_on_workers = gol_run_serially;
+    }
+    return(GOL_OK);
+}
+
+GOL_API gol_result
+gol_create_board(uint32_t rows, uint32_t columns, const char *rule_text, gol_board **result)
+{
+    if(!result)
+    {
+        return(GOL_INVALID_ARGUMENT);
+    }
+    *result = 0;
+    if(rows == 0 || columns == 0)
+    {
+        return(GOL_INVALID_ARGUMENT);
+    }
+
+    // NOTE(ian): parse_life_rule only reads the text.
+    life_rule rule = get_conway_rule();
+    if(rule_text && !parse_life_rule((char *)rule_text, &rule))
+    {
+        return(GOL_INVALID_RULE);
+    }
+
+    gol_initialize_platform();
+
+    // NOTE(ian): Reserve the first block ourselves, big enough for every
+    // plane, so running out of address space is an error and not an Assert
+    // further down. Anything that doesn't fit (Larger than Life's prefix
+    // rows, on big radii) just chains another block.
+    u64 plane_bytes = (u64)rows*get_words_per_row(columns)*sizeof(u64) + LIFE_GRID_ALIGNMENT;
+    u64 block_size = 2*(1 + get_age_plane_count(rule.state_count))*plane_bytes + Megabytes(1);
+    // NOTE(ian): Huge pages only when one thread steps every band. We can't
+    // tell which nodes the caller's workers are on, and a 2MB page spans
+    // many bands, so with workers we leave placement to first-touch.
+    memory_arena arena;
+    initialize_arena(&arena, block_size,
+                     (global_platform.worker_count > 1) ? 0 : Platform_Memory_Huge_Pages);
+    arena.current_block = global_platform.allocate_memory(block_size, arena.allocation_flags);
+    if(!arena.current_block)
+    {
+        return(GOL_OUT_OF_MEMORY);
+    }
+
+    // NOTE(ian): The board lives in its own arena, so freeing that frees
+    // everything.
+    gol_board *board = Push_Struct(&arena, gol_board);
+    initialize_arena(&board->scratch_arena, Megabytes(64));
+    initialize_board(&board->board, &arena, rows, columns, rule);
+    board->stats_stale = false;
+    board->arena = arena;
+
+    gol_add_board_count(1);
+    *result = board;
+    return(GOL_OK);
+}
+
+GOL_API void
+gol_destroy_board(gol_board *board)
+{
+    if(board)
+    {
+        memory_arena arena = board->arena;
+        free_arena(&board->scratch_arena);
+        free_arena(&arena);
+        gol_add_board_count(-1);
+    }
+}
+
+GOL_API gol_result
+gol_load_board(const char *path, const char *rule, gol_board **result)
+{
+    if(!path || !result)
+    {
+        return(GOL_INVALID_ARGUMENT);
+    }
+    *result = 0;
+
+    FILE *file = gol_open_file(path, "rb");
+    if(!file)
+    {
+        return(GOL_FILE_ERROR);
+    }
+
+    gol_result status = GOL_OK;
+    life_grid_file_header header;
+    if(fread(&header, sizeof(header), 1, file) != 1 ||
+       header.magic != LIFE_GRID_FILE_MAGIC ||
+       header.version != LIFE_GRID_FILE_VERSION ||
+       header.rows == 0 || header.columns == 0 ||
+       header.words_per_row != get_words_per_row(header.columns) ||
+       header.header_size < sizeof(header))
+    {
+        status = GOL_INVALID_FILE;
+    }
+
+    // NOTE(ian): Read our way past the rest of the header rather than seek,
+    // since fseek only takes a long.
+    u32 skip = (status == GOL_OK) ? (u32)(header.header_size - sizeof(header)) : 0;
+    while(status == GOL_OK && skip)
+    {
+        u8 padding[256];
+        u32 chunk = (skip < sizeof(padding)) ? skip : (u32)sizeof(padding);
+        if(fread(padding, chunk, 1, file) != 1)
+        {
+            status = GOL_INVALID_FILE;
+        }
+        skip -= chunk;
+    }
+
+    if(status == GOL_OK)
+    {
+        status = gol_create_board(header.rows, header.columns, rule, result);
+    }
+
+    if(status == GOL_OK)
+    {
+        // NOTE(ian): The file's rows are laid out just like ours, so they go
+        // straight into the grid.
+        life_grid *grid = &(*result)->board.grid;
+        u64 size = (u64)grid->rows*grid->words_per_row*sizeof(u64);
+        if(fread(grid->words, (size_t)size, 1, file) == 1)
+        {
+            u32 word_count = (grid->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+            for(u32 row = 0;
+                row < grid->rows;
+                row += 1)
+            {
+                u64 *words = get_grid_row(grid, row);
+                words[word_count - 1] &= grid->last_word_mask;
+                for(u32 word_index = word_count;
+                    word_index < grid->words_per_row;
+                    word_index += 1)
+                {
+                    words[word_index] = 0;
+                }
+            }
+            (*result)->board.generation = header.generation;
+            count_board_stats(&(*result)->board);
+        }
+        else
+        {
+            gol_destroy_board(*result);
+            *result = 0;
+            status = GOL_INVALID_FILE;
+        }
+    }
+
+    fclose(file);
+    return(status);
+}
+
+GOL_API gol_result
+gol_save_board(gol_board *board, const char *path)
+{
+    if(!board || !path)
+    {
+        return(GOL_INVALID_ARGUMENT);
+    }
+
+    FILE *file = gol_open_file(path, "wb");
+    if(!file)
+    {
+        return(GOL_FILE_ERROR);
+    }
+
+    life_grid *grid = &board->board.grid;
+    life_grid_file_header header = {};
+    header.magic = LIFE_GRID_FILE_MAGIC;
+    header.version = LIFE_GRID_FILE_VERSION;
+    header.rows = grid->rows;
+    header.columns = grid->columns;
+    header.words_per_row = grid->words_per_row;
+    header.header_size = (u32)LIFE_GRID_FILE_HEADER_SIZE;
+    header.generation = board->board.generation;
+
+    local_persist u8 padding[LIFE_GRID_FILE_HEADER_SIZE];
+    u64 size = (u64)grid->rows*grid->words_per_row*sizeof(u64);
+    bool32 written = (fwrite(&header, sizeof(header), 1, file) == 1 &&
+                      fwrite(padding, LIFE_GRID_FILE_HEADER_SIZE - sizeof(header), 1, file) == 1 &&
+                      fwrite(grid->words, (size_t)size, 1, file) == 1);
+    written = (fclose(file) == 0) && written;
+
+    gol_result result = written ? GOL_OK : GOL_FILE_ERROR;
+    return(result);
+}
+
+GOL_API void
+gol_step_board(gol_board *board, uint64_t generation_count)
+{
+    while(generation_count)
+    {
+        u32 count = LIFE_MAX_BLOCK_GENERATIONS;
+        if(generation_count < count)
+        {
+            count = (u32)generation_count;
+        }
+
+        if(count > 1)
+        {
+            step_board_blocked(&board->board, count, &board->scratch_arena);
+        }
+        else
+        {
+            step_board(&board->board);
+        }
+        board->stats_stale = false;
+        generation_count -= count;
+    }
+}
+
+GOL_API void
+gol_get_board_info(gol_board *board, gol_board_info *info)
+{
+    if(board->stats_stale)
+    {
+        count_board_stats(&board->board);
+        board->stats_stale = false;
+    }
+
+    life_board *life = &board->board;
+    info->rows = life->grid.rows;
+    info->columns = life->grid.columns;
+    info->words_per_row = life->grid.words_per_row;
+    info->state_count = life->rule.state_count;
+    info->generation = life->generation;
+    info->population = life->stats.population;
+}
+
+GOL_API const uint64_t *
+gol_get_row(gol_board *board, uint32_t row)
+{
+    life_grid *grid = &board->board.grid;
+    const uint64_t *result = (row < grid->rows) ? get_grid_row(grid, row) : 0;
+    return(result);
+}
+
+GOL_API uint32_t
+gol_get_cell_state(gol_board *board, uint32_t row, uint32_t column)
+{
+    life_board *life = &board->board;
+    u32 result = 0;
+    if(row < life->grid.rows && column < life->grid.columns)
+    {
+        result = get_cell_state(life, row, column);
+    }
+    return(result);
+}
+
+GOL_API gol_result
+gol_set_cell_state(gol_board *board, uint32_t row, uint32_t column, uint32_t state)
+{
+    life_board *life = &board->board;
+    if(row >= life->grid.rows || column >= life->grid.columns || state >= life->rule.state_count)
+    {
+        return(GOL_INVALID_ARGUMENT);
+    }
+
+    set_cell_state(life, row, column, state);
+    board->stats_stale = true;
+    return(GOL_OK);
+}
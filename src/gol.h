@@ -0,0 +1,107 @@
+#ifndef GOL_H
+
+// NOTE(ian): libgol, the engine behind a plain C API, for anything that wants
+// to run boards in-process instead of going through files: our own window,
+// analysis tools, other languages over FFI.
+//
+// Boards are opaque. Rows come back as a pointer straight into the board's
+// current generation, one bit per cell, the leftmost column in the lowest bit
+// of each 64-bit word, with bits past the last column always zero. Row r
+// starts words_per_row words after row 0. The pointer stays good until the
+// board is next stepped, edited or destroyed.
+//
+// Calls on one board mustn't overlap. Different boards can be used from
+// different threads, but they share the worker pool given to gol_set_workers,
+// so its run_on_workers can then be called from several threads at once. It
+// has to run those jobs one after another, by holding a lock for the whole
+// call, as linux_life's and win32_life's pools do.
+//
+// Build with GOL_SHARED defined for a shared library (and GOL_EXPORTS too
+// when building the library itself); leave both off to link it statically.
+
+#include <stdint.h>
+
+#define GOL_VERSION 1
+
+#if defined(GOL_SHARED) && defined(_WIN32)
+#if defined(GOL_EXPORTS)
+#define GOL_EXPORT __declspec(dllexport)
+#else
+#define GOL_EXPORT __declspec(dllimport)
+#endif
+#elif defined(GOL_SHARED)
+#define GOL_EXPORT __attribute__((visibility("default")))
+#else
+#define GOL_EXPORT
+#endif
+
+#ifdef __cplusplus
+#define GOL_API extern "C" GOL_EXPORT
+#else
+#define GOL_API GOL_EXPORT
+#endif
+
+typedef struct gol_board gol_board;
+
+typedef enum gol_result
+{
+    GOL_OK = 0,
+    GOL_INVALID_ARGUMENT,
+    GOL_INVALID_RULE,
+    GOL_OUT_OF_MEMORY,
+    GOL_FILE_ERROR,    // NOTE(ian): couldn't open, read or write the file
+    GOL_INVALID_FILE,  // NOTE(ian): not a grid file we understand
+} gol_result;
+
+typedef struct gol_board_info
+{
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t words_per_row;
+    uint32_t state_count; // NOTE(ian): 2, or more for Generations rules
+    uint64_t generation;
+    uint64_t population;
+} gol_board_info;
+
+// NOTE(ian): Same shape as the engine's worker hooks: run_on_workers calls
+// callback once for each worker index below worker_count, in parallel, and
+// returns when they're all done.
+typedef void gol_work_callback(uint32_t worker_index, void *data);
+typedef void gol_run_on_workers(gol_work_callback *callback, void *data);
+
+// NOTE(ian): GOL_VERSION as the library was built; compare against the one
+// you compiled with.
+GOL_API uint32_t gol_get_version(void);
+
+GOL_API const char *gol_get_result_string(gol_result result);
+
+// NOTE(ian): Boards step on the calling thread unless you hand the library a
+// worker pool. Boards split their rows between the workers when they're
+// created, so this has to happen before there are any.
+GOL_API gol_result gol_set_workers(uint32_t worker_count, gol_run_on_workers *run_on_workers);
+
+// NOTE(ian): rule is any notation the engine parses (B3/S23, /2/3,
+// R5,C0,M1,S34..58,B34..45,NM, ...), or null for Conway's. The board
+// starts out dead.
+GOL_API gol_result gol_create_board(uint32_t rows, uint32_t columns, const char *rule,
+                                    gol_board **result);
+GOL_API void gol_destroy_board(gol_board *board);
+
+// NOTE(ian): Grid files are the format linux_life streams (-f, -c): a header
+// and the packed rows. They hold live cells only, so dying cells of a
+// Generations rule come back dead.
+GOL_API gol_result gol_load_board(const char *path, const char *rule, gol_board **result);
+GOL_API gol_result gol_save_board(gol_board *board, const char *path);
+
+GOL_API void gol_step_board(gol_board *board, uint64_t generation_count);
+
+GOL_API void gol_get_board_info(gol_board *board, gol_board_info *info);
+GOL_API const uint64_t *gol_get_row(gol_board *board, uint32_t row);
+
+// NOTE(ian): 0 is dead, 1 alive, and 2 up dying.
+GOL_API uint32_t gol_get_cell_state(gol_board *board, uint32_t row, uint32_t column);
+GOL_API gol_result gol_set_cell_state(gol_board *board, uint32_t row, uint32_t column,
+                                      uint32_t state);
+
+#define GOL_H
+#endif
@@ -0,0 +1,222 @@
+#ifndef LIFE_H
+
+// NOTE(ian): The engine: boards, rules and everything done to them. gol.cpp
+// wraps it in the C API in gol.h; linux_life builds it straight in.
+
+#include "cross_platform.h"
+
+global_variable platform_api global_platform;
+
+#include "life_intrinsics.h"
+#include "life_memory.h"
+#include "life_rule.h"
+#include "life_grid.h"
+#include "life_index.h"
+#include "life_edit.h"
+#include "life_search.h"
+#include "life_record.h"
+
+// NOTE(ian): t runs from 0 for off_pixel to 256 for on_pixel.
+inline u32
+blend_overview_pixel(u32 off_pixel, u32 on_pixel, u32 t)
+{
+    u32 red   = (((off_pixel >> 16) & 0xFF)*(256 - t) + ((on_pixel >> 16) & 0xFF)*t) >> 8;
+    u32 green = (((off_pixel >> 8) & 0xFF)*(256 - t) + ((on_pixel >> 8) & 0xFF)*t) >> 8;
+    u32 blue  = ((off_pixel & 0xFF)*(256 - t) + (on_pixel & 0xFF)*t) >> 8;
+    u32 result = (red << 16) | (green << 8) | blue;
+    return(result);
+}
+
+inline u64
+get_overview_step(game_graphics_buffer *buffer, life_grid *grid)
+{
+    // NOTE(ian): 16.16 fixed point cells per pixel, the same on both axes.
+    u64 step_x = ((u64)grid->columns << 16) / (u64)buffer->width;
+    u64 step_y = ((u64)grid->rows << 16) / (u64)buffer->height;
+    u64 step = (step_x > step_y) ? step_x : step_y;
+    if(step == 0)
+    {
+        step = 1;
+    }
+    return(step);
+}
+
+// NOTE(ian): Shrinks (or blows up) a whole grid to fit the buffer, keeping
+// its aspect ratio, for boards far too big to draw cell by cell.
+// Without an index this point-samples one cell per pixel, so sparse patterns
+// flicker in and out at high zoom-outs. With one (kept up to date with the
+// grid), each pixel that covers more than a cell is shaded by how many of
+// its cells are alive instead, which costs the same whatever the zoom.
+internal void
+draw_grid_overview(game_graphics_buffer *buffer, life_grid *grid,
+                   color on_color, color off_color,
+                   life_population_index *index = 0)
+{
+    u32 on_pixel  = ((u32(on_color.r * 255.0f) << 16) |
+                     (u32(on_color.g * 255.0f) << 8) |
+                     u32(on_color.b * 255.0f));
+    u32 off_pixel = ((u32(off_color.r * 255.0f) << 16) |
+                     (u32(off_color.g * 255.0f) << 8) |
+                     u32(off_color.b * 255.0f));
+
+    u64 step = get_overview_step(buffer, grid);
+    if(index && step > (1 << 16))
+    {
+        u8 *row = (u8 *)buffer->memory;
+        for(int y = 0;
+            y < buffer->height;
+            y += 1)
+        {
+            u32 first_row = (u32)(((u64)y*step) >> 16);
+            u32 end_row = (u32)(((u64)(y + 1)*step) >> 16);
+            u32 *pixel = (u32 *)row;
+            for(int x = 0;
+                x < buffer->width;
+                x += 1)
+            {
+                u32 first_column = (u32)(((u64)x*step) >> 16);
+                u32 end_column = (u32)(((u64)(x + 1)*step) >> 16);
+
+                // NOTE(ian): 0 to 256 for dead to alive.
+                u32 t = 0;
+                if(first_row < grid->rows && first_column < grid->columns)
+                {
+                    if(end_row > grid->rows)
+                    {
+                        end_row = grid->rows;
+                    }
+                    if(end_column > grid->columns)
+                    {
+                        end_column = grid->columns;
+                    }
+                    u64 area = (u64)(end_row - first_row)*(end_column - first_column);
+                    u64 count = count_live_cells(index, first_row, first_column, end_row, end_column);
+                    t = (u32)((count*256) / area);
+                }
+
+                *pixel++ = blend_overview_pixel(off_pixel, on_pixel, t);
+            }
+            row += buffer->bytes_per_row;
+        }
+        return;
+    }
+
+    u8 *row = (u8 *)buffer->memory;
+    for(int y = 0;
+        y < buffer->height;
+        y += 1)
+    {
+        u64 cell_row = ((u64)y*step) >> 16;
+        u64 *words = (cell_row < grid->rows) ? get_grid_row(grid, (u32)cell_row) : 0;
+
+        u32 *pixel = (u32 *)row;
+        for(int x = 0;
+            x < buffer->width;
+            x += 1)
+        {
+            u64 cell_column = ((u64)x*step) >> 16;
+            bool32 alive = (words && cell_column < grid->columns &&
+                            ((words[cell_column / LIFE_WORD_BITS] >>
+                              (cell_column % LIFE_WORD_BITS)) & 1));
+            *pixel++ = alive ? on_pixel : off_pixel;
+        }
+        row += buffer->bytes_per_row;
+    }
+}
+
+// NOTE(ian): The same picture draw_grid_overview draws with an index, but
+// counted straight off the grid a row of pixels at a time, for grids that
+// don't have one (and threads that can't borrow the workers to update one).
+// It costs a masked popcount per pixel per cell row instead of a few lookups
+// per pixel. counts needs room for a u32 per pixel column.
+internal void
+draw_grid_overview_counted(game_graphics_buffer *buffer, life_grid *grid,
+                           color on_color, color off_color, u32 *counts)
+{
+    u64 step = get_overview_step(buffer, grid);
+    if(step <= (1 << 16))
+    {
+        draw_grid_overview(buffer, grid, on_color, off_color);
+        return;
+    }
+
+    u32 on_pixel  = ((u32(on_color.r * 255.0f) << 16) |
+                     (u32(on_color.g * 255.0f) << 8) |
+                     u32(on_color.b * 255.0f));
+    u32 off_pixel = ((u32(off_color.r * 255.0f) << 16) |
+                     (u32(off_color.g * 255.0f) << 8) |
+                     u32(off_color.b * 255.0f));
+
+    u8 *row = (u8 *)buffer->memory;
+    for(int y = 0;
+        y < buffer->height;
+        y += 1)
+    {
+        u32 first_row = (u32)(((u64)y*step) >> 16);
+        u32 end_row = (u32)(((u64)(y + 1)*step) >> 16);
+        if(end_row > grid->rows)
+        {
+            end_row = grid->rows;
+        }
+
+        for(int x = 0;
+            x < buffer->width;
+            x += 1)
+        {
+            counts[x] = 0;
+        }
+        for(u32 cell_row = first_row;
+            cell_row < end_row;
+            cell_row += 1)
+        {
+            u64 *words = get_grid_row(grid, cell_row);
+            for(int x = 0;
+                x < buffer->width;
+                x += 1)
+            {
+                u32 first_column = (u32)(((u64)x*step) >> 16);
+                u32 end_column = (u32)(((u64)(x + 1)*step) >> 16);
+                if(first_column >= grid->columns)
+                {
+                    break;
+                }
+                if(end_column > grid->columns)
+                {
+                    end_column = grid->columns;
+                }
+                for(u32 word_index = first_column / LIFE_WORD_BITS;
+                    word_index <= (end_column - 1) / LIFE_WORD_BITS;
+                    word_index += 1)
+                {
+                    counts[x] += count_set_bits(words[word_index] &
+                                                get_column_mask(word_index, first_column, end_column));
+                }
+            }
+        }
+
+        u32 *pixel = (u32 *)row;
+        for(int x = 0;
+            x < buffer->width;
+            x += 1)
+        {
+            u32 first_column = (u32)(((u64)x*step) >> 16);
+            u32 end_column = (u32)(((u64)(x + 1)*step) >> 16);
+
+            u32 t = 0;
+            if(first_row < grid->rows && first_column < grid->columns)
+            {
+                if(end_column > grid->columns)
+                {
+                    end_column = grid->columns;
+                }
+                u64 area = (u64)(end_row - first_row)*(end_column - first_column);
+                t = (u32)(((u64)counts[x]*256) / area);
+            }
+            *pixel++ = blend_overview_pixel(off_pixel, on_pixel, t);
+        }
+        row += buffer->bytes_per_row;
+    }
+}
+
+#define LIFE_H
+#endif
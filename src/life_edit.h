@@ -0,0 +1,596 @@
+#ifndef LIFE_EDIT_H
+
+// NOTE(ian): Bulk edits. Everything here works a word (64 cells) at a time,
+// masking off the cells outside the edited columns at each end of a row, so
+// the cost is per word rather than per cell.
+//
+// The grid functions just change bits. The board ones wrap them and keep the
+// rest of the board consistent: edited cells end up alive or dead (not
+// dying), an attached population index hears about the edited tiles, and
+// board->stats is recounted. Births and deaths come out zero after an edit,
+// the same as count_board_stats.
+
+enum life_paste_mode
+{
+    Life_Paste_Or,   // NOTE(ian): live pattern cells are set, the rest left alone
+    Life_Paste_Xor,  // NOTE(ian): live pattern cells are toggled
+    Life_Paste_Copy, // NOTE(ian): the pattern's whole rectangle replaces what was there
+};
+
+// NOTE(ian): Transpose happens first, then the flips, so for an R x C source
+// the transposed ones come out C x R. Rotations are clockwise.
+enum life_transform
+{
+    Life_Transform_Identity = 0,
+    Life_Transform_Flip_Horizontal = 0x1, // NOTE(ian): mirror left to right
+    Life_Transform_Flip_Vertical = 0x2,   // NOTE(ian): mirror top to bottom
+    Life_Transform_Transpose = 0x4,       // NOTE(ian): mirror in the main diagonal
+
+    Life_Transform_Rotate_90 = Life_Transform_Transpose | Life_Transform_Flip_Horizontal,
+    Life_Transform_Rotate_180 = Life_Transform_Flip_Horizontal | Life_Transform_Flip_Vertical,
+    Life_Transform_Rotate_270 = Life_Transform_Transpose | Life_Transform_Flip_Vertical,
+    Life_Transform_Anti_Transpose = (Life_Transform_Transpose | Life_Transform_Flip_Horizontal |
+                                     Life_Transform_Flip_Vertical),
+
+    Life_Transform_Count,
+};
+
+// NOTE(ian): The bits of word word_index that fall in columns
+// [first_column, end_column).
+inline u64
+get_column_mask(u32 word_index, u32 first_column, u32 end_column)
+{
+    u32 word_first = word_index*LIFE_WORD_BITS;
+    u64 result = ~0ULL;
+    if(first_column > word_first)
+    {
+        result = (first_column - word_first < LIFE_WORD_BITS) ? (~0ULL << (first_column - word_first)) : 0;
+    }
+    if(end_column < word_first + LIFE_WORD_BITS)
+    {
+        result &= (end_column > word_first) ? ((1ULL << (end_column - word_first)) - 1) : 0;
+    }
+    return(result);
+}
+
+// NOTE(ian): Clips a rectangle to the grid. Returns false if nothing is left.
+internal bool32
+clip_grid_rect(life_grid *grid, u32 *first_row, u32 *first_column, u32 *end_row, u32 *end_column)
+{
+    if(*end_row > grid->rows)
+    {
+        *end_row = grid->rows;
+    }
+    if(*end_column > grid->columns)
+    {
+        *end_column = grid->columns;
+    }
+    bool32 result = (*first_row < *end_row && *first_column < *end_column);
+    return(result);
+}
+
+internal void
+fill_grid_rect(life_grid *grid, u32 first_row, u32 first_column, u32 end_row, u32 end_column,
+               bool32 alive)
+{
+    if(clip_grid_rect(grid, &first_row, &first_column, &end_row, &end_column))
+    {
+        u32 first_word = first_column / LIFE_WORD_BITS;
+        u32 end_word = (end_column + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+        for(u32 row = first_row;
+            row < end_row;
+            row += 1)
+        {
+            u64 *words = get_grid_row(grid, row);
+            for(u32 word_index = first_word;
+                word_index < end_word;
+                word_index += 1)
+            {
+                u64 mask = get_column_mask(word_index, first_column, end_column);
+                words[word_index] = alive ? (words[word_index] | mask) : (words[word_index] & ~mask);
+            }
+        }
+    }
+}
+
+// NOTE(ian): The 64 cells of a row starting at first_bit, which needn't be
+// word aligned. Cells past the end of the row are dead.
+inline u64
+get_row_bits(u64 *words, u32 word_count, s64 first_bit)
+{
+    u64 result = 0;
+    s64 word_index = first_bit >> 6;
+    u32 shift = (u32)(first_bit & 63);
+    if(word_index >= 0 && word_index < word_count)
+    {
+        result = words[word_index] >> shift;
+    }
+    if(shift && word_index + 1 >= 0 && word_index + 1 < word_count)
+    {
+        result |= words[word_index + 1] << (LIFE_WORD_BITS - shift);
+    }
+    return(result);
+}
+
+// NOTE(ian): Pastes pattern with its top left corner at (row, column) of dest.
+// Either can be negative, and whatever falls outside dest is dropped.
+internal void
+paste_grid(life_grid *dest, life_grid *pattern, s32 row, s32 column, life_paste_mode mode)
+{
+    s64 first_row = (row > 0) ? row : 0;
+    s64 end_row = (s64)row + pattern->rows;
+    s64 first_column = (column > 0) ? column : 0;
+    s64 end_column = (s64)column + pattern->columns;
+    if(end_row > dest->rows)
+    {
+        end_row = dest->rows;
+    }
+    if(end_column > dest->columns)
+    {
+        end_column = dest->columns;
+    }
+    if(first_row >= end_row || first_column >= end_column)
+    {
+        return;
+    }
+
+    u32 pattern_word_count = (pattern->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    u32 first_word = (u32)(first_column / LIFE_WORD_BITS);
+    u32 end_word = (u32)((end_column + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS);
+    for(s64 dest_row = first_row;
+        dest_row < end_row;
+        dest_row += 1)
+    {
+        u64 *words = get_grid_row(dest, (u32)dest_row);
+        u64 *pattern_words = get_grid_row(pattern, (u32)(dest_row - row));
+        for(u32 word_index = first_word;
+            word_index < end_word;
+            word_index += 1)
+        {
+            u64 mask = get_column_mask(word_index, (u32)first_column, (u32)end_column);
+            u64 bits = get_row_bits(pattern_words, pattern_word_count,
+                                    (s64)word_index*LIFE_WORD_BITS - column) & mask;
+            if(mode == Life_Paste_Or)
+            {
+                words[word_index] |= bits;
+            }
+            else if(mode == Life_Paste_Xor)
+            {
+                words[word_index] ^= bits;
+            }
+            else
+            {
+                words[word_index] = (words[word_index] & ~mask) | bits;
+            }
+        }
+    }
+}
+
+// NOTE(ian): Transposes a 64x64 block of cells in place (word i is row i):
+// swap the off-diagonal 32x32 quadrants, then the 16x16 ones inside each
+// quadrant, and so on down to single cells. Six passes of 32 word pairs.
+internal void
+transpose_block(u64 *block)
+{
+    u32 half = 32;
+    u64 mask = 0x00000000FFFFFFFFULL;
+    while(half)
+    {
+        for(u32 row = 0;
+            row < LIFE_WORD_BITS;
+            row = ((row | half) + 1) & ~half)
+        {
+            u64 swap = ((block[row] >> half) ^ block[row | half]) & mask;
+            block[row] ^= swap << half;
+            block[row | half] ^= swap;
+        }
+        half >>= 1;
+        mask ^= mask << half;
+    }
+}
+
+// NOTE(ian): Mirrors one row left to right in place: reverse the words and
+// the bits within them, which puts the row at the top of its last word, then
+// shift it back down.
+internal void
+flip_row(u64 *words, u32 columns)
+{
+    u32 word_count = (columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    for(u32 word_index = 0;
+        word_index < word_count / 2;
+        word_index += 1)
+    {
+        u64 swap = reverse_bits(words[word_index]);
+        words[word_index] = reverse_bits(words[word_count - 1 - word_index]);
+        words[word_count - 1 - word_index] = swap;
+    }
+    if(word_count & 1)
+    {
+        words[word_count / 2] = reverse_bits(words[word_count / 2]);
+    }
+
+    u32 shift = word_count*LIFE_WORD_BITS - columns;
+    if(shift)
+    {
+        for(u32 word_index = 0;
+            word_index < word_count;
+            word_index += 1)
+        {
+            u64 next = (word_index + 1 < word_count) ? words[word_index + 1] : 0;
+            words[word_index] = (words[word_index] >> shift) | (next << (LIFE_WORD_BITS - shift));
+        }
+    }
+}
+
+// NOTE(ian): dest has to be sized for the result (see life_transform) and
+// can't be source.
+internal void
+transform_grid(life_grid *dest, life_grid *source, life_transform transform)
+{
+    Assert(dest->words != source->words);
+    if(transform & Life_Transform_Transpose)
+    {
+        Assert(dest->rows == source->columns && dest->columns == source->rows);
+        u32 source_word_count = (source->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+        for(u32 first_row = 0;
+            first_row < source->rows;
+            first_row += LIFE_WORD_BITS)
+        {
+            for(u32 word_index = 0;
+                word_index < source_word_count;
+                word_index += 1)
+            {
+                u64 block[LIFE_WORD_BITS];
+                for(u32 offset = 0;
+                    offset < LIFE_WORD_BITS;
+                    offset += 1)
+                {
+                    u32 row = first_row + offset;
+                    block[offset] = (row < source->rows) ? get_grid_row(source, row)[word_index] : 0;
+                }
+                transpose_block(block);
+                for(u32 offset = 0;
+                    offset < LIFE_WORD_BITS;
+                    offset += 1)
+                {
+                    u32 row = word_index*LIFE_WORD_BITS + offset;
+                    if(row < dest->rows)
+                    {
+                        get_grid_row(dest, row)[first_row / LIFE_WORD_BITS] = block[offset];
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        Assert(dest->rows == source->rows && dest->columns == source->columns);
+        memcpy(dest->words, source->words, (u64)source->rows*source->words_per_row*sizeof(u64));
+    }
+
+    if(transform & Life_Transform_Flip_Horizontal)
+    {
+        for(u32 row = 0;
+            row < dest->rows;
+            row += 1)
+        {
+            flip_row(get_grid_row(dest, row), dest->columns);
+        }
+    }
+    if(transform & Life_Transform_Flip_Vertical)
+    {
+        for(u32 row = 0;
+            row < dest->rows / 2;
+            row += 1)
+        {
+            u64 *top = get_grid_row(dest, row);
+            u64 *bottom = get_grid_row(dest, dest->rows - 1 - row);
+            for(u32 word_index = 0;
+                word_index < dest->words_per_row;
+                word_index += 1)
+            {
+                u64 swap = top[word_index];
+                top[word_index] = bottom[word_index];
+                bottom[word_index] = swap;
+            }
+        }
+    }
+}
+
+// NOTE(ian): A transformed copy of source, pushed on arena.
+internal life_grid
+push_transformed_grid(memory_arena *arena, life_grid *source, life_transform transform)
+{
+    life_grid result;
+    if(transform & Life_Transform_Transpose)
+    {
+        push_grid(&result, arena, source->columns, source->rows);
+    }
+    else
+    {
+        push_grid(&result, arena, source->rows, source->columns);
+    }
+    clear_grid_rows(&result, 0, result.rows);
+    transform_grid(&result, source, transform);
+    return(result);
+}
+
+//
+// NOTE(ian): Random soup. The generator is xoshiro256++ run as four
+// independent lanes, with the state stored lane-minor so the four updates are
+// the same operation on adjacent words and the compiler can do them as one
+// vector op. It has no multiplies, so that works on plain AVX2 too.
+//
+// A cell is alive with probability density, to 1/65536: with d = density in
+// 16-bit fixed point, start from a random word and, for each bit of d from the
+// lowest set one up, OR in (bit set) or AND in (bit clear) another random
+// word. Each cell comes out alive with probability exactly d/65536, and
+// density 1/2 costs one random word per 64 cells.
+//
+
+#define LIFE_RANDOM_LANES 4
+#define LIFE_DENSITY_BITS 16
+
+struct life_random
+{
+    u64 state[4][LIFE_RANDOM_LANES];
+};
+
+// NOTE(ian): splitmix64, for turning one seed into a generator's worth.
+inline u64
+get_seed_bits(u64 *seed)
+{
+    *seed += 0x9E3779B97F4A7C15ULL;
+    u64 result = *seed;
+    result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+    result ^= result >> 31;
+    return(result);
+}
+
+// NOTE(ian): Each row gets its own stream, so a soup is the same however the
+// rows are split between threads (or streamed to a file in chunks).
+internal void
+seed_row_random(life_random *random, u64 seed, u32 row)
+{
+    u64 state = seed ^ ((u64)row << 32) ^ row;
+    for(u32 index = 0;
+        index < 4;
+        index += 1)
+    {
+        for(u32 lane = 0;
+            lane < LIFE_RANDOM_LANES;
+            lane += 1)
+        {
+            random->state[index][lane] = get_seed_bits(&state);
+        }
+    }
+}
+
+inline void
+get_random_words(life_random *random, u64 *words)
+{
+    u64 *s0 = random->state[0];
+    u64 *s1 = random->state[1];
+    u64 *s2 = random->state[2];
+    u64 *s3 = random->state[3];
+    for(u32 lane = 0;
+        lane < LIFE_RANDOM_LANES;
+        lane += 1)
+    {
+        words[lane] = rotate_left(s0[lane] + s3[lane], 23) + s0[lane];
+        u64 t = s1[lane] << 17;
+        s2[lane] ^= s0[lane];
+        s3[lane] ^= s1[lane];
+        s1[lane] ^= s2[lane];
+        s0[lane] ^= s3[lane];
+        s2[lane] ^= t;
+        s3[lane] = rotate_left(s3[lane], 45);
+    }
+}
+
+inline u32
+get_density_level(f32 density)
+{
+    u32 result = 0;
+    if(density >= 1.0f)
+    {
+        result = 1 << LIFE_DENSITY_BITS;
+    }
+    else if(density > 0.0f)
+    {
+        result = (u32)(density*(f32)(1 << LIFE_DENSITY_BITS) + 0.5f);
+    }
+    return(result);
+}
+
+// NOTE(ian): Fills columns [first_column, end_column) of one row with soup at
+// the given density level (see get_density_level).
+internal void
+fill_row_random(u64 *words, u32 first_column, u32 end_column, u32 level, life_random *random)
+{
+    u32 first_word = first_column / LIFE_WORD_BITS;
+    u32 end_word = (end_column + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    u32 first_level_bit = level ? find_lowest_set_bit(level) : LIFE_DENSITY_BITS;
+
+    for(u32 word_index = first_word;
+        word_index < end_word;
+        word_index += LIFE_RANDOM_LANES)
+    {
+        u64 bits[LIFE_RANDOM_LANES];
+        for(u32 lane = 0;
+            lane < LIFE_RANDOM_LANES;
+            lane += 1)
+        {
+            bits[lane] = (level >> LIFE_DENSITY_BITS) ? ~0ULL : 0;
+        }
+
+        if(first_level_bit < LIFE_DENSITY_BITS)
+        {
+            get_random_words(random, bits);
+            for(u32 level_bit = first_level_bit + 1;
+                level_bit < LIFE_DENSITY_BITS;
+                level_bit += 1)
+            {
+                u64 more[LIFE_RANDOM_LANES];
+                get_random_words(random, more);
+                u64 set = 0ULL - (u64)((level >> level_bit) & 1);
+                for(u32 lane = 0;
+                    lane < LIFE_RANDOM_LANES;
+                    lane += 1)
+                {
+                    bits[lane] = (set & (bits[lane] | more[lane])) | (~set & bits[lane] & more[lane]);
+                }
+            }
+        }
+
+        for(u32 lane = 0;
+            lane < LIFE_RANDOM_LANES && word_index + lane < end_word;
+            lane += 1)
+        {
+            u64 mask = get_column_mask(word_index + lane, first_column, end_column);
+            words[word_index + lane] = (words[word_index + lane] & ~mask) | (bits[lane] & mask);
+        }
+    }
+}
+
+internal void
+fill_grid_random(life_grid *grid, u32 first_row, u32 first_column, u32 end_row, u32 end_column,
+                 f32 density, u64 seed)
+{
+    if(clip_grid_rect(grid, &first_row, &first_column, &end_row, &end_column))
+    {
+        u32 level = get_density_level(density);
+        for(u32 row = first_row;
+            row < end_row;
+            row += 1)
+        {
+            life_random random;
+            seed_row_random(&random, seed, row);
+            fill_row_random(get_grid_row(grid, row), first_column, end_column, level, &random);
+        }
+    }
+}
+
+//
+// NOTE(ian): Board edits.
+//
+
+// NOTE(ian): Makes every edited cell alive or dead, not dying: with
+// clear_all the whole rectangle's ages go, otherwise just those of cells
+// that are now alive.
+internal void
+settle_edited_ages(life_board *board, u32 first_row, u32 first_column, u32 end_row, u32 end_column,
+                   bool32 clear_all)
+{
+    u32 first_word = first_column / LIFE_WORD_BITS;
+    u32 end_word = (end_column + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    for(u32 plane = 0;
+        plane < board->age_plane_count;
+        plane += 1)
+    {
+        for(u32 row = first_row;
+            row < end_row;
+            row += 1)
+        {
+            u64 *alive = get_grid_row(&board->grid, row);
+            u64 *ages = get_grid_row(&board->age_planes[plane], row);
+            for(u32 word_index = first_word;
+                word_index < end_word;
+                word_index += 1)
+            {
+                u64 mask = get_column_mask(word_index, first_column, end_column);
+                if(!clear_all)
+                {
+                    mask &= alive[word_index];
+                }
+                ages[word_index] &= ~mask;
+            }
+        }
+    }
+}
+
+internal void
+finish_board_edit(life_board *board, u32 first_row, u32 first_column, u32 end_row, u32 end_column,
+                  bool32 clear_ages)
+{
+    if(clip_grid_rect(&board->grid, &first_row, &first_column, &end_row, &end_column))
+    {
+        settle_edited_ages(board, first_row, first_column, end_row, end_column, clear_ages);
+        mark_population_index_changed(board, first_row, first_column, end_row, end_column);
+    }
+    count_board_stats(board);
+}
+
+internal void
+stamp_pattern(life_board *board, life_grid *pattern, s32 row, s32 column, life_paste_mode mode)
+{
+    paste_grid(&board->grid, pattern, row, column, mode);
+
+    s64 first_row = (row > 0) ? row : 0;
+    s64 first_column = (column > 0) ? column : 0;
+    s64 end_row = (s64)row + pattern->rows;
+    s64 end_column = (s64)column + pattern->columns;
+    if(end_row > 0 && end_column > 0)
+    {
+        finish_board_edit(board, (u32)first_row, (u32)first_column,
+                          (u32)((end_row < board->grid.rows) ? end_row : board->grid.rows),
+                          (u32)((end_column < board->grid.columns) ? end_column : board->grid.columns),
+                          mode == Life_Paste_Copy);
+    }
+}
+
+internal void
+fill_board_rect(life_board *board, u32 first_row, u32 first_column, u32 end_row, u32 end_column,
+                bool32 alive)
+{
+    fill_grid_rect(&board->grid, first_row, first_column, end_row, end_column, alive);
+    finish_board_edit(board, first_row, first_column, end_row, end_column, true);
+}
+
+struct life_random_fill
+{
+    life_board *board;
+    u32 first_row;
+    u32 first_column;
+    u32 end_row;
+    u32 end_column;
+    f32 density;
+    u64 seed;
+};
+
+internal
+PLATFORM_WORK_CALLBACK(fill_band_random_work)
+{
+    life_random_fill *fill = (life_random_fill *)data;
+    life_board *board = fill->board;
+    if(worker_index < board->band_count)
+    {
+        life_band *band = board->bands + worker_index;
+        u32 first_row = (band->first_row > fill->first_row) ? band->first_row : fill->first_row;
+        u32 end_row = (band->end_row < fill->end_row) ? band->end_row : fill->end_row;
+        fill_grid_random(&board->grid, first_row, fill->first_column, end_row, fill->end_column,
+                         fill->density, fill->seed);
+    }
+}
+
+// NOTE(ian): Each worker fills the rows of its own band, so a board-sized
+// soup is written at memory speed and the pages stay on their nodes.
+internal void
+fill_board_random(life_board *board, u32 first_row, u32 first_column, u32 end_row, u32 end_column,
+                  f32 density, u64 seed)
+{
+    life_random_fill fill;
+    fill.board = board;
+    fill.first_row = first_row;
+    fill.first_column = first_column;
+    fill.end_row = end_row;
+    fill.end_column = end_column;
+    fill.density = density;
+    fill.seed = seed;
+    global_platform.run_on_workers(fill_band_random_work, &fill);
+    finish_board_edit(board, first_row, first_column, end_row, end_column, true);
+}
+
+#define LIFE_EDIT_H
+#endif
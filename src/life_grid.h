@@ -0,0 +1,1388 @@
+#ifndef LIFE_GRID_H
+
+// NOTE(ian): The grid is packed one cell per bit. Cell (row, col) is bit
+// (col % 64) of word (col / 64) in its row, so the low bit is the leftmost
+// cell. Rows are padded out to a whole cache line, and bits past the last
+// column are always zero; the step kernel relies on that.
+//
+// Everything outside the grid counts as dead.
+//
+// Rules with more than two states (see life_rule.h) keep the grid as the
+// plane of live cells, so everything that only cares about alive/dead works
+// unchanged, and store the age of dying cells in extra bit planes laid out
+// exactly like the grid.
+
+#define LIFE_WORD_BITS 64
+#define LIFE_ROW_WORD_ALIGNMENT 8
+
+// NOTE(ian): Bands are handed out in multiples of this many rows. With rows
+// padded to 64 bytes, 64 rows is always a whole number of 4KB pages, so no
+// 4KB page is ever shared by two bands (and first-touch puts each page where
+// it belongs). A 2MB page holds many bands, and Windows commits large pages
+// up front on whichever thread asks, so a board whose bands are touched from
+// different NUMA nodes has to come out of an arena without
+// Platform_Memory_Huge_Pages.
+#define LIFE_BAND_ROW_GRANULARITY 64
+#define LIFE_GRID_ALIGNMENT Kilobytes(4)
+
+// NOTE(ian): The population index (life_index.h) works in tiles of this many
+// rows by one word. It divides the band granularity, so a tile never
+// straddles two bands and each tile's change flag has a single writer.
+#define LIFE_INDEX_TILE_ROWS 64
+
+struct life_grid
+{
+    u32 rows;
+    u32 columns;
+    u32 words_per_row;
+    u64 last_word_mask;
+    u64 *words;
+};
+
+// NOTE(ian): What a step found out about the generation it produced,
+// gathered row by row while the rows are still in cache, so nobody needs a
+// second pass over the grid to get them.
+struct life_stats
+{
+    u64 population;
+    u64 births; // NOTE(ian): cells that came alive this generation
+    u64 deaths; // NOTE(ian): cells that stopped being alive (died or started dying)
+
+    // NOTE(ian): Inclusive bounding box of the live cells. Empty (and
+    // meaningless) when population is zero.
+    u32 min_row;
+    u32 max_row;
+    u32 min_column;
+    u32 max_column;
+};
+
+struct life_band
+{
+    u32 first_row;
+    u32 end_row;
+
+    // NOTE(ian): Larger than Life scratch, null otherwise: prefix sums for
+    // the 2*radius + 1 rows around the one being stepped, kept in a ring, and
+    // the running Moore count of each column. Von Neumann rules also get a
+    // ring of 2*radius + 2 diagonal rows (see add_diagonal_row).
+    u32 *prefix_rows;
+    u32 *column_counts;
+    u32 *diagonal_rows;
+
+    life_stats stats; // NOTE(ian): for this band's rows, merged into the board's
+};
+
+struct life_board
+{
+    life_grid grid;      // NOTE(ian): the current generation
+    life_grid temp_grid; // NOTE(ian): the next generation, swapped in after each step
+    u64 *zero_row;
+
+    life_rule rule;
+    u32 age_plane_count;
+    life_grid age_planes[LIFE_MAX_AGE_PLANES];      // NOTE(ian): bit p of each dying cell's age
+    life_grid temp_age_planes[LIFE_MAX_AGE_PLANES];
+
+    // NOTE(ian): One band per worker thread. The worker that steps a band is
+    // also the one that first touched its pages, so on NUMA hosts the rows
+    // live on the node that's going to read them.
+    u32 band_count;
+    life_band *bands;
+
+    u64 generation;
+    life_stats stats; // NOTE(ian): of grid, as of the last step (or count_board_stats)
+
+    // NOTE(ian): One byte per index tile, row by row, set by the kernels when
+    // a step changes anything in the tile. Null unless a population index is
+    // attached.
+    u8 *changed_tiles;
+};
+
+// NOTE(ian): On-disk grids are this header followed by the packed rows,
+// exactly as they sit in memory (words_per_row words each). The header is
+// padded out to a page so the rows can be mapped straight from the file.
+#define LIFE_GRID_FILE_MAGIC 0x4546494C // "LIFE"
+#define LIFE_GRID_FILE_VERSION 1
+#define LIFE_GRID_FILE_HEADER_SIZE Kilobytes(4)
+
+struct life_grid_file_header
+{
+    u32 magic;
+    u32 version;
+    u32 rows;
+    u32 columns;
+    u32 words_per_row;
+    u32 header_size;
+    u64 generation;
+};
+
+inline u32
+get_words_per_row(u32 columns)
+{
+    u32 words = (columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    u32 result = ((words + LIFE_ROW_WORD_ALIGNMENT - 1) /
+                  LIFE_ROW_WORD_ALIGNMENT) * LIFE_ROW_WORD_ALIGNMENT;
+    return(result);
+}
+
+inline u64
+get_last_word_mask(u32 columns)
+{
+    u64 result = ~0ULL;
+    if(columns % LIFE_WORD_BITS)
+    {
+        result = (1ULL << (columns % LIFE_WORD_BITS)) - 1;
+    }
+    return(result);
+}
+
+inline u64 *
+get_grid_row(life_grid *grid, u32 row)
+{
+    u64 *result = grid->words + (u64)row*grid->words_per_row;
+    return(result);
+}
+
+inline bool32
+get_cell(life_grid *grid, u32 row, u32 col)
+{
+    Assert(row < grid->rows && col < grid->columns);
+    u64 word = get_grid_row(grid, row)[col / LIFE_WORD_BITS];
+    bool32 result = (bool32)((word >> (col % LIFE_WORD_BITS)) & 1);
+    return(result);
+}
+
+inline void
+set_cell(life_grid *grid, u32 row, u32 col, bool32 alive)
+{
+    Assert(row < grid->rows && col < grid->columns);
+    u64 *word = get_grid_row(grid, row) + (col / LIFE_WORD_BITS);
+    u64 bit = 1ULL << (col % LIFE_WORD_BITS);
+    if(alive)
+    {
+        *word |= bit;
+    }
+    else
+    {
+        *word &= ~bit;
+    }
+}
+
+// NOTE(ian): 0 is dead, 1 alive, and 2 up dying (see life_rule.h).
+inline u32
+get_cell_state(life_board *board, u32 row, u32 col)
+{
+    u32 result = get_cell(&board->grid, row, col) ? 1 : 0;
+    u32 age = 0;
+    for(u32 plane = 0;
+        plane < board->age_plane_count;
+        plane += 1)
+    {
+        age |= (u32)get_cell(&board->age_planes[plane], row, col) << plane;
+    }
+    if(age)
+    {
+        result = age + 1;
+    }
+    return(result);
+}
+
+inline void
+set_cell_state(life_board *board, u32 row, u32 col, u32 state)
+{
+    Assert(state < board->rule.state_count);
+    set_cell(&board->grid, row, col, state == 1);
+    u32 age = (state > 1) ? (state - 1) : 0;
+    for(u32 plane = 0;
+        plane < board->age_plane_count;
+        plane += 1)
+    {
+        set_cell(&board->age_planes[plane], row, col, (age >> plane) & 1);
+    }
+}
+
+inline void
+clear_stats(life_stats *stats)
+{
+    stats->population = 0;
+    stats->births = 0;
+    stats->deaths = 0;
+    stats->min_row = 0xFFFFFFFF;
+    stats->max_row = 0;
+    stats->min_column = 0xFFFFFFFF;
+    stats->max_column = 0;
+}
+
+inline void
+merge_stats(life_stats *stats, life_stats *other)
+{
+    stats->population += other->population;
+    stats->births += other->births;
+    stats->deaths += other->deaths;
+    if(other->population)
+    {
+        if(other->min_row < stats->min_row)
+        {
+            stats->min_row = other->min_row;
+        }
+        if(other->max_row > stats->max_row)
+        {
+            stats->max_row = other->max_row;
+        }
+        if(other->min_column < stats->min_column)
+        {
+            stats->min_column = other->min_column;
+        }
+        if(other->max_column > stats->max_column)
+        {
+            stats->max_column = other->max_column;
+        }
+    }
+}
+
+// NOTE(ian): Running totals for one row while a kernel steps it. Everything
+// is kept in registers and only folded into the band's life_stats at the end
+// of the row.
+struct life_row_stats
+{
+    u64 population;
+    u64 births;
+    u64 deaths;
+    u32 first_live_word; // NOTE(ian): word_count when the row is empty
+    u32 last_live_word;
+};
+
+inline void
+begin_row_stats(life_row_stats *row_stats, u32 word_count)
+{
+    row_stats->population = 0;
+    row_stats->births = 0;
+    row_stats->deaths = 0;
+    row_stats->first_live_word = word_count;
+    row_stats->last_live_word = word_count;
+}
+
+inline void
+add_word_stats(life_row_stats *row_stats, u32 word_index, u64 word, u64 previous,
+               u32 word_count)
+{
+    row_stats->population += count_set_bits(word);
+    row_stats->births += count_set_bits(word & ~previous);
+    row_stats->deaths += count_set_bits(previous & ~word);
+
+    // NOTE(ian): Written so the compiler can use conditional moves; whether a
+    // word is empty is about as unpredictable as the board.
+    bool32 live = (word != 0);
+    row_stats->first_live_word = ((live && row_stats->first_live_word == word_count) ?
+                                  word_index : row_stats->first_live_word);
+    row_stats->last_live_word = live ? word_index : row_stats->last_live_word;
+}
+
+// NOTE(ian): words are the row's new words, the first of which holds
+// first_column.
+internal void
+end_row_stats(life_stats *stats, life_row_stats *row_stats, u32 row, u64 *words,
+              u32 first_column)
+{
+    u64 population = row_stats->population;
+    u32 first_live_word = row_stats->first_live_word;
+    u32 last_live_word = row_stats->last_live_word;
+
+    stats->population += population;
+    stats->births += row_stats->births;
+    stats->deaths += row_stats->deaths;
+    if(population)
+    {
+        u32 min_column = (first_column + first_live_word*LIFE_WORD_BITS +
+                          find_lowest_set_bit(words[first_live_word]));
+        u32 max_column = (first_column + last_live_word*LIFE_WORD_BITS +
+                          find_highest_set_bit(words[last_live_word]));
+        if(row < stats->min_row)
+        {
+            stats->min_row = row;
+        }
+        if(row > stats->max_row)
+        {
+            stats->max_row = row;
+        }
+        if(min_column < stats->min_column)
+        {
+            stats->min_column = min_column;
+        }
+        if(max_column > stats->max_column)
+        {
+            stats->max_column = max_column;
+        }
+    }
+}
+
+// NOTE(ian): The change flags for the index tiles that row falls in, lined
+// up with its words, or null when nobody is indexing the board.
+inline u8 *
+get_changed_tiles_row(u8 *changed_tiles, life_grid *grid, u32 row)
+{
+    u8 *result = 0;
+    if(changed_tiles)
+    {
+        u32 word_count = (grid->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+        result = changed_tiles + (u64)(row / LIFE_INDEX_TILE_ROWS)*word_count;
+    }
+    return(result);
+}
+
+// NOTE(ian): For kernels that write whole rows before we can look at them.
+// previous is the same words a generation earlier, or null to count a grid
+// as it stands. Both were just touched, so this runs out of L1. Words that
+// differ from previous flag their tile in changed_words, when given.
+internal void
+add_row_stats(life_stats *stats, u32 row, u64 *words, u64 *previous,
+              u32 word_count, u32 first_column, u8 *changed_words = 0)
+{
+    life_row_stats row_stats;
+    begin_row_stats(&row_stats, word_count);
+    for(u32 word_index = 0;
+        word_index < word_count;
+        word_index += 1)
+    {
+        add_word_stats(&row_stats, word_index, words[word_index],
+                       previous ? previous[word_index] : words[word_index], word_count);
+    }
+    end_row_stats(stats, &row_stats, row, words, first_column);
+
+    if(changed_words && previous)
+    {
+        for(u32 word_index = 0;
+            word_index < word_count;
+            word_index += 1)
+        {
+            changed_words[word_index] |= (u8)(words[word_index] != previous[word_index]);
+        }
+    }
+}
+
+internal void
+clear_grid_rows(life_grid *grid, u32 first_row, u32 end_row)
+{
+    for(u32 row = first_row;
+        row < end_row;
+        row += 1)
+    {
+        u64 *words = get_grid_row(grid, row);
+        for(u32 word_index = 0;
+            word_index < grid->words_per_row;
+            word_index += 1)
+        {
+            words[word_index] = 0;
+        }
+    }
+}
+
+internal void
+push_grid(life_grid *grid, memory_arena *arena, u32 rows, u32 columns)
+{
+    grid->rows = rows;
+    grid->columns = columns;
+    grid->words_per_row = get_words_per_row(columns);
+    grid->last_word_mask = get_last_word_mask(columns);
+
+    // NOTE(ian): Not cleared here! Whoever steps a band clears it first so the
+    // pages get faulted in on the right node.
+    grid->words = Push_Array(arena, (u64)rows*grid->words_per_row, u64, LIFE_GRID_ALIGNMENT);
+}
+
+// NOTE(ian): A bit-sliced adder: the eight neighbor bits of 64 cells are
+// summed at once into a 4-bit count (s0..s3) per cell.
+struct life_neighbor_count
+{
+    u64 s0;
+    u64 s1;
+    u64 s2;
+    u64 s3;
+};
+
+inline life_neighbor_count
+count_neighbors(u64 above_west, u64 above_word, u64 above_east,
+                u64 row_west, u64 row_east,
+                u64 below_west, u64 below_word, u64 below_east)
+{
+    // NOTE(ian): Three neighbors above and below, two beside us.
+    u64 a0 = above_west ^ above_word ^ above_east;
+    u64 a1 = (above_west & above_word) | (above_east & (above_west ^ above_word));
+    u64 m0 = row_west ^ row_east;
+    u64 m1 = row_west & row_east;
+    u64 b0 = below_west ^ below_word ^ below_east;
+    u64 b1 = (below_west & below_word) | (below_east & (below_west ^ below_word));
+
+    life_neighbor_count result;
+    result.s0 = a0 ^ m0 ^ b0;
+    u64 carry = (a0 & m0) | (b0 & (a0 ^ m0));
+
+    u64 p = a1 ^ m1;
+    u64 q = a1 & m1;
+    u64 r = b1 ^ carry;
+    u64 t = b1 & carry;
+    result.s1 = p ^ r;
+    u64 u = p & r;
+    result.s2 = q ^ t ^ u;
+    result.s3 = q & t;
+    return(result);
+}
+
+// NOTE(ian): Advances one row under Conway's rule. above/below may point at a
+// zero row at the edges of the board. The row's stats are gathered on the way
+// when stats isn't null, and changed words flag their index tile when
+// changed_words isn't.
+internal void
+step_row(u64 *above, u64 *row, u64 *below, u64 *result,
+         u32 word_count, u64 last_word_mask,
+         life_stats *stats = 0, u32 row_index = 0, u8 *changed_words = 0)
+{
+    life_row_stats row_stats;
+    begin_row_stats(&row_stats, word_count);
+
+    u64 above_prev = 0;
+    u64 row_prev = 0;
+    u64 below_prev = 0;
+
+    u64 above_word = above[0];
+    u64 row_word = row[0];
+    u64 below_word = below[0];
+
+    for(u32 word_index = 0;
+        word_index < word_count;
+        word_index += 1)
+    {
+        u64 above_next = 0;
+        u64 row_next = 0;
+        u64 below_next = 0;
+        u64 mask = last_word_mask;
+        if(word_index + 1 < word_count)
+        {
+            above_next = above[word_index + 1];
+            row_next = row[word_index + 1];
+            below_next = below[word_index + 1];
+            mask = ~0ULL;
+        }
+
+        // NOTE(ian): "west" lines the left neighbor of each cell up with the
+        // cell itself, "east" the right neighbor.
+        u64 above_west = (above_word << 1) | (above_prev >> 63);
+        u64 above_east = (above_word >> 1) | (above_next << 63);
+        u64 row_west = (row_word << 1) | (row_prev >> 63);
+        u64 row_east = (row_word >> 1) | (row_next << 63);
+        u64 below_west = (below_word << 1) | (below_prev >> 63);
+        u64 below_east = (below_word >> 1) | (below_next << 63);
+
+        life_neighbor_count count = count_neighbors(above_west, above_word, above_east,
+                                                    row_west, row_east,
+                                                    below_west, below_word, below_east);
+
+        // NOTE(ian): Alive next generation with exactly three neighbors, or
+        // with two if we're alive now.
+        u64 next = count.s1 & ~count.s2 & ~count.s3 & (count.s0 | row_word) & mask;
+        result[word_index] = next;
+        add_word_stats(&row_stats, word_index, next, row_word, word_count);
+        if(changed_words)
+        {
+            changed_words[word_index] |= (u8)(next != row_word);
+        }
+
+        above_prev = above_word;
+        row_prev = row_word;
+        below_prev = below_word;
+        above_word = above_next;
+        row_word = row_next;
+        below_word = below_next;
+    }
+
+    if(stats)
+    {
+        end_row_stats(stats, &row_stats, row_index, result, 0);
+    }
+}
+
+internal void
+step_grid_rows(life_grid *source, life_grid *dest, u64 *zero_row,
+               u32 first_row, u32 end_row, life_stats *stats, u8 *changed_tiles)
+{
+    u32 word_count = (source->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    for(u32 row = first_row;
+        row < end_row;
+        row += 1)
+    {
+        u64 *above = (row > 0) ? get_grid_row(source, row - 1) : zero_row;
+        u64 *below = (row + 1 < source->rows) ? get_grid_row(source, row + 1) : zero_row;
+        step_row(above, get_grid_row(source, row), below,
+                 get_grid_row(dest, row), word_count, source->last_word_mask,
+                 stats, row, get_changed_tiles_row(changed_tiles, source, row));
+    }
+}
+
+// NOTE(ian): Given which of 64 cells have a neighbour count that gives birth
+// and which have one that survives, works out the new live word and advances
+// the age planes. Any age bit set means dying; "oldest" cells are on their
+// last dying state and go dead now.
+inline u64
+apply_rule_states(u64 alive, u64 born, u64 stays,
+                  u64 **ages, u64 **next_ages, u32 age_plane_count,
+                  u32 oldest_age, u32 word_index)
+{
+    u64 dying = 0;
+    u64 oldest = ~0ULL;
+    for(u32 plane = 0;
+        plane < age_plane_count;
+        plane += 1)
+    {
+        u64 age = ages[plane][word_index];
+        dying |= age;
+        oldest &= ((oldest_age >> plane) & 1) ? age : ~age;
+    }
+    oldest &= dying;
+
+    // NOTE(ian): Add one to every dying age (a ripple carry across the
+    // planes), zero the oldest, and start live cells that didn't survive
+    // at age 1.
+    u64 carry = dying & ~oldest;
+    for(u32 plane = 0;
+        plane < age_plane_count;
+        plane += 1)
+    {
+        u64 age = ages[plane][word_index] & ~oldest;
+        next_ages[plane][word_index] = age ^ carry;
+        carry &= age;
+    }
+    if(age_plane_count)
+    {
+        next_ages[0][word_index] |= alive & ~stays;
+    }
+
+    u64 result = (alive & stays) | (~alive & ~dying & born);
+    return(result);
+}
+
+// NOTE(ian): Advances one row under any rule. ages/next_ages are the rows of
+// the board's age planes. All the states move together with plain bitwise
+// logic, so a Generations rule costs a few more ops per word than Conway's,
+// not a per-cell switch on the state.
+internal void
+step_rule_row(life_rule *rule, u64 *above, u64 *row, u64 *below, u64 *result,
+              u64 **ages, u64 **next_ages, u32 age_plane_count,
+              u32 word_count, u64 last_word_mask)
+{
+    u64 birth[LIFE_MAX_NEIGHBOR_COUNT + 1];
+    u64 survive[LIFE_MAX_NEIGHBOR_COUNT + 1];
+    get_count_selectors(rule->birth, birth);
+    get_count_selectors(rule->survive, survive);
+    u32 oldest_age = rule->state_count - 2;
+
+    u64 above_prev = 0;
+    u64 row_prev = 0;
+    u64 below_prev = 0;
+
+    u64 above_word = above[0];
+    u64 row_word = row[0];
+    u64 below_word = below[0];
+
+    for(u32 word_index = 0;
+        word_index < word_count;
+        word_index += 1)
+    {
+        u64 above_next = 0;
+        u64 row_next = 0;
+        u64 below_next = 0;
+        if(word_index + 1 < word_count)
+        {
+            above_next = above[word_index + 1];
+            row_next = row[word_index + 1];
+            below_next = below[word_index + 1];
+        }
+
+        u64 above_west = (above_word << 1) | (above_prev >> 63);
+        u64 above_east = (above_word >> 1) | (above_next << 63);
+        u64 row_west = (row_word << 1) | (row_prev >> 63);
+        u64 row_east = (row_word >> 1) | (row_next << 63);
+        u64 below_west = (below_word << 1) | (below_prev >> 63);
+        u64 below_east = (below_word >> 1) | (below_next << 63);
+
+        life_neighbor_count count = count_neighbors(above_west, above_word, above_east,
+                                                    row_west, row_east,
+                                                    below_west, below_word, below_east);
+        u64 born = match_neighbor_count(count.s0, count.s1, count.s2, count.s3, birth);
+        u64 stays = match_neighbor_count(count.s0, count.s1, count.s2, count.s3, survive);
+        result[word_index] = apply_rule_states(row_word, born, stays, ages, next_ages,
+                                               age_plane_count, oldest_age, word_index);
+
+        above_prev = above_word;
+        row_prev = row_word;
+        below_prev = below_word;
+        above_word = above_next;
+        row_word = row_next;
+        below_word = below_next;
+    }
+
+    result[word_count - 1] &= last_word_mask;
+}
+
+//
+// NOTE(ian): Larger than Life. Counting a radius-R neighbourhood cell by cell
+// is (2R+1)^2 reads per cell, so instead each row gets a prefix sum, which
+// makes any horizontal span of it two reads. For the Moore square we then
+// keep a running count per column of its 2R+1 spans, adding the row that
+// enters the window and taking away the one that leaves, which is O(1) per
+// cell whatever the radius. The von Neumann diamond's span width changes
+// from row to row, so its span ends run along diagonals instead; summing the
+// prefix rows down both diagonals makes each half of the diamond four reads,
+// again whatever the radius.
+//
+
+inline u32 *
+get_prefix_row(life_band *band, life_grid *grid, u32 radius, s64 row)
+{
+    u32 *result = band->prefix_rows + (u64)(row % (2*radius + 1))*(grid->columns + 1);
+    return(result);
+}
+
+// NOTE(ian): prefix[c] is the number of live cells in columns [0, c).
+internal void
+get_row_prefix(life_grid *grid, u32 row, u32 *prefix)
+{
+    u64 *words = get_grid_row(grid, row);
+    u32 sum = 0;
+    prefix[0] = 0;
+    for(u32 column = 0;
+        column < grid->columns;
+        column += 1)
+    {
+        sum += (u32)((words[column / LIFE_WORD_BITS] >> (column % LIFE_WORD_BITS)) & 1);
+        prefix[column + 1] = sum;
+    }
+}
+
+inline u32
+get_span_count(u32 *prefix, s32 column, s32 half_width, s32 columns)
+{
+    s32 first = column - half_width;
+    s32 end = column + half_width + 1;
+    if(first < 0)
+    {
+        first = 0;
+    }
+    if(end > columns)
+    {
+        end = columns;
+    }
+    u32 result = prefix[end] - prefix[first];
+    return(result);
+}
+
+// NOTE(ian): A diagonal row is columns + radius + 1 down sums, then as many
+// up sums, then the running total of whole rows.
+inline u32
+get_diagonal_width(u32 columns, u32 radius)
+{
+    u32 result = columns + radius + 1;
+    return(result);
+}
+
+inline u32 *
+get_diagonal_row(life_band *band, life_grid *grid, u32 radius, s64 row)
+{
+    // NOTE(ian): Rows start from just above the band, which can be above the
+    // board, so bias them positive before wrapping.
+    s64 ring_count = 2*radius + 2;
+    u64 ring_index = (u64)((row + ring_count) % ring_count);
+    u32 *result = band->diagonal_rows + ring_index*(2*get_diagonal_width(grid->columns, radius) + 1);
+    return(result);
+}
+
+inline u32
+get_down_sum(u32 *diagonal, s32 x)
+{
+    u32 result = (x > 0) ? diagonal[x] : 0;
+    return(result);
+}
+
+inline u32
+get_up_sum(u32 *diagonal, s32 x, s32 columns, s32 radius)
+{
+    u32 width = get_diagonal_width((u32)columns, (u32)radius);
+    u32 result = (x > columns) ? diagonal[2*width] : diagonal[width + (u32)(x + radius)];
+    return(result);
+}
+
+// NOTE(ian): With P_j(x) the prefix of row j clamped to [0, columns], row r's
+// diagonal sums are
+//     down_r(x) = P_r(x) + down_{r-1}(x - 1)   (0 for x <= 0)
+//     up_r(x)   = P_r(x) + up_{r-1}(x + 1)     (the whole-row total past columns)
+// each running from a zero row just above the band. The diamond's span ends
+// fall on these diagonals, so it's the difference of two of them at either
+// end of its upper and lower halves. Rows off the board count as empty, but
+// still get a diagonal row so the sums carry through them.
+internal void
+add_diagonal_row(life_band *band, life_grid *grid, u32 radius, s64 row)
+{
+    s32 columns = (s32)grid->columns;
+    s32 range = (s32)radius;
+    u32 width = get_diagonal_width(grid->columns, radius);
+    u32 *prefix = (row >= 0 && row < (s64)grid->rows) ? get_prefix_row(band, grid, radius, row) : 0;
+    u32 *previous = get_diagonal_row(band, grid, radius, row - 1);
+    u32 *diagonal = get_diagonal_row(band, grid, radius, row);
+
+    diagonal[0] = 0;
+    for(s32 x = 1;
+        x <= columns + range;
+        x += 1)
+    {
+        u32 here = prefix ? prefix[(x < columns) ? x : columns] : 0;
+        diagonal[x] = here + previous[x - 1];
+    }
+    for(s32 x = -range;
+        x <= columns;
+        x += 1)
+    {
+        u32 here = prefix ? prefix[(x > 0) ? x : 0] : 0;
+        diagonal[width + (u32)(x + range)] = here + get_up_sum(previous, x + 1, columns, range);
+    }
+    diagonal[2*width] = (prefix ? prefix[columns] : 0) + previous[2*width];
+}
+
+// NOTE(ian): sign is +1 as a row enters the Moore window and -1 as it leaves.
+internal void
+add_span_counts(u32 *column_counts, u32 *prefix, u32 radius, s32 columns, s32 sign)
+{
+    for(s32 column = 0;
+        column < columns;
+        column += 1)
+    {
+        column_counts[column] += (u32)(sign*(s32)get_span_count(prefix, column, radius, columns));
+    }
+}
+
+// NOTE(ian): How many u32s a band's ring of diagonal rows takes.
+inline u64
+get_diagonal_count(life_rule *rule, u32 columns)
+{
+    u64 result = (u64)(2*rule->radius + 2)*(2*get_diagonal_width(columns, rule->radius) + 1);
+    return(result);
+}
+
+internal void
+step_range_rows(life_board *board, life_band *band, u32 first_row, u32 end_row)
+{
+    life_rule *rule = &board->rule;
+    life_grid *source = &board->grid;
+    s32 rows = (s32)source->rows;
+    s32 columns = (s32)source->columns;
+    s32 radius = (s32)rule->radius;
+    bool32 moore = (rule->neighborhood == Life_Neighborhood_Moore);
+    u32 word_count = (source->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    u32 oldest_age = rule->state_count - 2;
+
+    // NOTE(ian): Prime the window with the rows above first_row and all but
+    // the last row below it; the loop brings that one in.
+    for(s32 column = 0;
+        column < columns;
+        column += 1)
+    {
+        band->column_counts[column] = 0;
+    }
+    if(!moore)
+    {
+        memset(get_diagonal_row(band, source, radius, (s64)first_row - radius - 1), 0,
+               (2*get_diagonal_width(source->columns, radius) + 1)*sizeof(u32));
+    }
+    for(s32 row = (s32)first_row - radius;
+        row < (s32)first_row + radius;
+        row += 1)
+    {
+        if(row >= 0 && row < rows)
+        {
+            u32 *prefix = get_prefix_row(band, source, radius, row);
+            get_row_prefix(source, row, prefix);
+            if(moore)
+            {
+                add_span_counts(band->column_counts, prefix, radius, columns, 1);
+            }
+        }
+        if(!moore)
+        {
+            add_diagonal_row(band, source, radius, row);
+        }
+    }
+
+    for(s32 row = (s32)first_row;
+        row < (s32)end_row;
+        row += 1)
+    {
+        s32 entering = row + radius;
+        if(entering < rows)
+        {
+            u32 *prefix = get_prefix_row(band, source, radius, entering);
+            get_row_prefix(source, entering, prefix);
+            if(moore)
+            {
+                add_span_counts(band->column_counts, prefix, radius, columns, 1);
+            }
+        }
+        if(!moore)
+        {
+            add_diagonal_row(band, source, radius, entering);
+        }
+
+        u64 *ages[LIFE_MAX_AGE_PLANES];
+        u64 *next_ages[LIFE_MAX_AGE_PLANES];
+        for(u32 plane = 0;
+            plane < board->age_plane_count;
+            plane += 1)
+        {
+            ages[plane] = get_grid_row(&board->age_planes[plane], row);
+            next_ages[plane] = get_grid_row(&board->temp_age_planes[plane], row);
+        }
+
+        // NOTE(ian): The diamond's upper half runs from the diagonals just
+        // above it to this row's, and its lower half from this row's to
+        // the bottom one's.
+        u32 *diagonal_top = 0;
+        u32 *diagonal_middle = 0;
+        u32 *diagonal_bottom = 0;
+        if(!moore)
+        {
+            diagonal_top = get_diagonal_row(band, source, radius, (s64)row - radius - 1);
+            diagonal_middle = get_diagonal_row(band, source, radius, row);
+            diagonal_bottom = get_diagonal_row(band, source, radius, (s64)row + radius);
+        }
+
+        u64 *words = get_grid_row(source, row);
+        u64 *result = get_grid_row(&board->temp_grid, row);
+        for(u32 word_index = 0;
+            word_index < word_count;
+            word_index += 1)
+        {
+            u64 alive = words[word_index];
+            u64 born = 0;
+            u64 stays = 0;
+
+            s32 first_column = (s32)(word_index*LIFE_WORD_BITS);
+            s32 end_column = first_column + LIFE_WORD_BITS;
+            if(end_column > columns)
+            {
+                end_column = columns;
+            }
+            for(s32 column = first_column;
+                column < end_column;
+                column += 1)
+            {
+                u32 count = 0;
+                if(moore)
+                {
+                    count = band->column_counts[column];
+                }
+                else
+                {
+                    count = (get_down_sum(diagonal_middle, column + radius + 1) -
+                             get_down_sum(diagonal_top, column) -
+                             get_up_sum(diagonal_middle, column - radius, columns, radius) +
+                             get_up_sum(diagonal_top, column + 1, columns, radius) +
+                             get_up_sum(diagonal_bottom, column + 1, columns, radius) -
+                             get_up_sum(diagonal_middle, column + radius + 1, columns, radius) -
+                             get_down_sum(diagonal_bottom, column) +
+                             get_down_sum(diagonal_middle, column - radius));
+                }
+
+                u32 bit = (u32)(column - first_column);
+                u32 self = (u32)((alive >> bit) & 1);
+                if(!rule->include_center)
+                {
+                    count -= self;
+                }
+
+                born |= (u64)(count >= rule->birth_min && count <= rule->birth_max) << bit;
+                stays |= (u64)(count >= rule->survive_min && count <= rule->survive_max) << bit;
+            }
+
+            result[word_index] = apply_rule_states(alive, born, stays, ages, next_ages,
+                                                   board->age_plane_count, oldest_age,
+                                                   word_index);
+        }
+        result[word_count - 1] &= source->last_word_mask;
+        add_row_stats(&band->stats, row, result, words, word_count, 0,
+                      get_changed_tiles_row(board->changed_tiles, source, row));
+
+        s32 leaving = row - radius;
+        if(moore && leaving >= 0)
+        {
+            add_span_counts(band->column_counts, get_prefix_row(band, source, radius, leaving),
+                            radius, columns, -1);
+        }
+    }
+}
+
+internal void
+step_board_rows(life_board *board, life_band *band, u32 first_row, u32 end_row)
+{
+    if(board->rule.radius)
+    {
+        step_range_rows(board, band, first_row, end_row);
+    }
+    else if(is_conway_rule(&board->rule))
+    {
+        step_grid_rows(&board->grid, &board->temp_grid, board->zero_row,
+                       first_row, end_row, &band->stats, board->changed_tiles);
+    }
+    else
+    {
+        life_grid *source = &board->grid;
+        u32 word_count = (source->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+        for(u32 row = first_row;
+            row < end_row;
+            row += 1)
+        {
+            u64 *ages[LIFE_MAX_AGE_PLANES];
+            u64 *next_ages[LIFE_MAX_AGE_PLANES];
+            for(u32 plane = 0;
+                plane < board->age_plane_count;
+                plane += 1)
+            {
+                ages[plane] = get_grid_row(&board->age_planes[plane], row);
+                next_ages[plane] = get_grid_row(&board->temp_age_planes[plane], row);
+            }
+
+            u64 *above = (row > 0) ? get_grid_row(source, row - 1) : board->zero_row;
+            u64 *below = (row + 1 < source->rows) ? get_grid_row(source, row + 1) : board->zero_row;
+            step_rule_row(&board->rule, above, get_grid_row(source, row), below,
+                          get_grid_row(&board->temp_grid, row),
+                          ages, next_ages, board->age_plane_count,
+                          word_count, source->last_word_mask);
+            add_row_stats(&band->stats, row, get_grid_row(&board->temp_grid, row),
+                          get_grid_row(source, row), word_count, 0,
+                          get_changed_tiles_row(board->changed_tiles, source, row));
+        }
+    }
+}
+
+internal
+PLATFORM_WORK_CALLBACK(first_touch_band_work)
+{
+    life_board *board = (life_board *)data;
+    if(worker_index < board->band_count)
+    {
+        life_band *band = board->bands + worker_index;
+        clear_grid_rows(&board->grid, band->first_row, band->end_row);
+        clear_grid_rows(&board->temp_grid, band->first_row, band->end_row);
+        for(u32 plane = 0;
+            plane < board->age_plane_count;
+            plane += 1)
+        {
+            clear_grid_rows(&board->age_planes[plane], band->first_row, band->end_row);
+            clear_grid_rows(&board->temp_age_planes[plane], band->first_row, band->end_row);
+        }
+        if(band->prefix_rows)
+        {
+            u64 prefix_count = (u64)(2*board->rule.radius + 1)*(board->grid.columns + 1);
+            memset(band->prefix_rows, 0, prefix_count*sizeof(u32));
+            memset(band->column_counts, 0, board->grid.columns*sizeof(u32));
+        }
+        if(band->diagonal_rows)
+        {
+            memset(band->diagonal_rows, 0, get_diagonal_count(&board->rule, board->grid.columns)*sizeof(u32));
+        }
+    }
+}
+
+internal
+PLATFORM_WORK_CALLBACK(step_band_work)
+{
+    life_board *board = (life_board *)data;
+    if(worker_index < board->band_count)
+    {
+        life_band *band = board->bands + worker_index;
+        clear_stats(&band->stats);
+        step_board_rows(board, band, band->first_row, band->end_row);
+    }
+}
+
+internal void
+merge_band_stats(life_board *board)
+{
+    clear_stats(&board->stats);
+    for(u32 band_index = 0;
+        band_index < board->band_count;
+        band_index += 1)
+    {
+        merge_stats(&board->stats, &board->bands[band_index].stats);
+    }
+}
+
+internal
+PLATFORM_WORK_CALLBACK(count_band_stats_work)
+{
+    life_board *board = (life_board *)data;
+    if(worker_index < board->band_count)
+    {
+        life_band *band = board->bands + worker_index;
+        u32 word_count = (board->grid.columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+        clear_stats(&band->stats);
+        for(u32 row = band->first_row;
+            row < band->end_row;
+            row += 1)
+        {
+            add_row_stats(&band->stats, row, get_grid_row(&board->grid, row), 0, word_count, 0);
+        }
+    }
+}
+
+// NOTE(ian): Stepping keeps board->stats up to date by itself. This is the
+// full pass for after cells have been edited by hand; births and deaths come
+// out zero.
+internal void
+count_board_stats(life_board *board)
+{
+    global_platform.run_on_workers(count_band_stats_work, board);
+    merge_band_stats(board);
+}
+
+internal void
+initialize_board(life_board *board, memory_arena *arena, u32 rows, u32 columns,
+                 life_rule rule)
+{
+    push_grid(&board->grid, arena, rows, columns);
+    push_grid(&board->temp_grid, arena, rows, columns);
+
+    board->rule = rule;
+    board->age_plane_count = get_age_plane_count(rule.state_count);
+    for(u32 plane = 0;
+        plane < board->age_plane_count;
+        plane += 1)
+    {
+        push_grid(&board->age_planes[plane], arena, rows, columns);
+        push_grid(&board->temp_age_planes[plane], arena, rows, columns);
+    }
+
+    board->zero_row = Push_Array(arena, board->grid.words_per_row, u64, ARENA_ROW_ALIGNMENT);
+    for(u32 word_index = 0;
+        word_index < board->grid.words_per_row;
+        word_index += 1)
+    {
+        board->zero_row[word_index] = 0;
+    }
+
+    // NOTE(ian): Split the rows evenly between the workers, rounding each
+    // band up to the band granularity. On small boards the last workers just
+    // end up with empty bands.
+    u32 worker_count = global_platform.worker_count;
+    if(worker_count == 0)
+    {
+        worker_count = 1;
+    }
+    u32 rows_per_band = (rows + worker_count - 1) / worker_count;
+    rows_per_band = ((rows_per_band + LIFE_BAND_ROW_GRANULARITY - 1) /
+                     LIFE_BAND_ROW_GRANULARITY) * LIFE_BAND_ROW_GRANULARITY;
+
+    board->band_count = worker_count;
+    board->bands = Push_Array(arena, worker_count, life_band);
+    for(u32 band_index = 0;
+        band_index < worker_count;
+        band_index += 1)
+    {
+        life_band *band = board->bands + band_index;
+        u64 first_row = (u64)band_index*rows_per_band;
+        u64 end_row = first_row + rows_per_band;
+        band->first_row = (u32)((first_row < rows) ? first_row : rows);
+        band->end_row = (u32)((end_row < rows) ? end_row : rows);
+
+        band->prefix_rows = 0;
+        band->column_counts = 0;
+        band->diagonal_rows = 0;
+        if(rule.radius)
+        {
+            u64 prefix_count = (u64)(2*rule.radius + 1)*(columns + 1);
+            band->prefix_rows = Push_Array(arena, prefix_count, u32, LIFE_GRID_ALIGNMENT);
+            band->column_counts = Push_Array(arena, columns, u32, LIFE_GRID_ALIGNMENT);
+            if(rule.neighborhood != Life_Neighborhood_Moore)
+            {
+                band->diagonal_rows = Push_Array(arena, get_diagonal_count(&rule, columns), u32,
+                                                 LIFE_GRID_ALIGNMENT);
+            }
+        }
+    }
+
+    board->generation = 0;
+    clear_stats(&board->stats);
+    board->changed_tiles = 0;
+    global_platform.run_on_workers(first_touch_band_work, board);
+}
+
+internal void
+step_board(life_board *board)
+{
+    global_platform.run_on_workers(step_band_work, board);
+    merge_band_stats(board);
+
+    life_grid swap = board->grid;
+    board->grid = board->temp_grid;
+    board->temp_grid = swap;
+    for(u32 plane = 0;
+        plane < board->age_plane_count;
+        plane += 1)
+    {
+        swap = board->age_planes[plane];
+        board->age_planes[plane] = board->temp_age_planes[plane];
+        board->temp_age_planes[plane] = swap;
+    }
+    board->generation += 1;
+}
+
+//
+// NOTE(ian): Temporal blocking. step_board streams the whole grid through
+// memory once per generation, which on big boards means we're waiting on DRAM
+// the whole time. Instead, each worker copies a tile plus a halo of k cells
+// into a pair of cache-sized buffers, runs k generations on them right there,
+// and writes only the middle of the tile back.
+//
+// Cells near the edge of a tile buffer go wrong because they can't see their
+// real neighbors, but the damage can only spread one cell per generation, so
+// after k generations everything at least k cells in from the edge is still
+// exact. Where the buffer edge is the edge of the board there's no damage at
+// all, since everything out there is dead anyway.
+//
+
+// NOTE(ian): Size each of the two buffers to sit comfortably in L2 together
+// with the other one.
+#define LIFE_TILE_BUFFER_BYTES Kilobytes(256)
+#define LIFE_TILE_MAX_WORDS 32
+#define LIFE_MAX_BLOCK_GENERATIONS 64
+
+struct life_tile_scratch
+{
+    u64 *buffers[2];
+};
+
+struct life_blocked_step
+{
+    life_board *board;
+    u32 generation_count;
+
+    u32 tile_rows;  // NOTE(ian): rows written back per tile, not counting the halo
+    u32 tile_words; // NOTE(ian): words written back per tile row, not counting the halo
+    u32 halo_words;
+
+    life_tile_scratch *scratch; // NOTE(ian): one per worker
+};
+
+internal void
+step_tile(life_blocked_step *step, life_tile_scratch *scratch, life_stats *stats,
+          u32 first_row, u32 end_row, u32 first_word, u32 end_word)
+{
+    life_board *board = step->board;
+    life_grid *source = &board->grid;
+    life_grid *dest = &board->temp_grid;
+    u32 k = step->generation_count;
+    u32 word_count = (source->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    bool32 conway = is_conway_rule(&board->rule);
+
+    u32 load_first_row = (first_row > k) ? (first_row - k) : 0;
+    u32 load_end_row = (end_row + k < source->rows) ? (end_row + k) : source->rows;
+    u32 load_first_word = (first_word > step->halo_words) ? (first_word - step->halo_words) : 0;
+    u32 load_end_word = ((end_word + step->halo_words) < word_count ?
+                         (end_word + step->halo_words) : word_count);
+
+    u32 buffer_rows = load_end_row - load_first_row;
+    u32 buffer_words = load_end_word - load_first_word;
+    u64 last_word_mask = (load_end_word == word_count) ? source->last_word_mask : ~0ULL;
+
+    u64 *from = scratch->buffers[0];
+    u64 *to = scratch->buffers[1];
+    for(u32 row = 0;
+        row < buffer_rows;
+        row += 1)
+    {
+        u64 *source_row = get_grid_row(source, load_first_row + row) + load_first_word;
+        u64 *buffer_row = from + (u64)row*buffer_words;
+        for(u32 word_index = 0;
+            word_index < buffer_words;
+            word_index += 1)
+        {
+            buffer_row[word_index] = source_row[word_index];
+        }
+    }
+
+    for(u32 generation = 1;
+        generation <= k;
+        generation += 1)
+    {
+        // NOTE(ian): Only rows that can still reach the middle of the tile
+        // get stepped, so the work shrinks by a row per side each generation.
+        // A side that sits on the edge of the board never shrinks.
+        u32 first = (load_first_row == 0) ? 0 : generation;
+        u32 end = (load_end_row == source->rows) ? buffer_rows : (buffer_rows - generation);
+        for(u32 row = first;
+            row < end;
+            row += 1)
+        {
+            u64 *above = (row > 0) ? (from + (u64)(row - 1)*buffer_words) : board->zero_row;
+            u64 *below = (row + 1 < buffer_rows) ? (from + (u64)(row + 1)*buffer_words) : board->zero_row;
+            if(conway)
+            {
+                step_row(above, from + (u64)row*buffer_words, below,
+                         to + (u64)row*buffer_words, buffer_words, last_word_mask);
+            }
+            else
+            {
+                step_rule_row(&board->rule, above, from + (u64)row*buffer_words, below,
+                              to + (u64)row*buffer_words, 0, 0, 0, buffer_words, last_word_mask);
+            }
+        }
+
+        u64 *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    // NOTE(ian): from holds the last generation and to the one before it,
+    // which is all the stats need. Tile change flags have to compare against
+    // where the pass started, though: a tile that changed and changed back
+    // within the pass would look untouched otherwise.
+    for(u32 row = first_row;
+        row < end_row;
+        row += 1)
+    {
+        u64 *buffer_row = from + (u64)(row - load_first_row)*buffer_words + (first_word - load_first_word);
+        u64 *previous_row = to + (u64)(row - load_first_row)*buffer_words + (first_word - load_first_word);
+        u64 *dest_row = get_grid_row(dest, row);
+        for(u32 word_index = first_word;
+            word_index < end_word;
+            word_index += 1)
+        {
+            dest_row[word_index] = *buffer_row++;
+        }
+        add_row_stats(stats, row, dest_row + first_word, previous_row,
+                      end_word - first_word, first_word*LIFE_WORD_BITS);
+
+        u8 *changed_words = get_changed_tiles_row(board->changed_tiles, source, row);
+        if(changed_words)
+        {
+            u64 *source_row = get_grid_row(source, row);
+            for(u32 word_index = first_word;
+                word_index < end_word;
+                word_index += 1)
+            {
+                changed_words[word_index] |= (u8)(dest_row[word_index] != source_row[word_index]);
+            }
+        }
+    }
+}
+
+internal
+PLATFORM_WORK_CALLBACK(step_band_blocked_work)
+{
+    life_blocked_step *step = (life_blocked_step *)data;
+    life_board *board = step->board;
+    if(worker_index < board->band_count)
+    {
+        life_band *band = board->bands + worker_index;
+        life_tile_scratch *scratch = step->scratch + worker_index;
+        clear_stats(&band->stats);
+        u32 word_count = (board->grid.columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+
+        for(u32 first_row = band->first_row;
+            first_row < band->end_row;
+            first_row += step->tile_rows)
+        {
+            u32 end_row = first_row + step->tile_rows;
+            if(end_row > band->end_row)
+            {
+                end_row = band->end_row;
+            }
+
+            for(u32 first_word = 0;
+                first_word < word_count;
+                first_word += step->tile_words)
+            {
+                u32 end_word = first_word + step->tile_words;
+                if(end_word > word_count)
+                {
+                    end_word = word_count;
+                }
+                step_tile(step, scratch, &band->stats, first_row, end_row, first_word, end_word);
+            }
+        }
+    }
+}
+
+// NOTE(ian): Advances the board generation_count generations, generation_count
+// at a time per tile pass. The result is exactly what calling step_board that
+// many times gives you. scratch_arena only needs to hold two tile buffers per
+// worker, and they're gone again when this returns. Tiles only carry the
+// live plane and reach a cell per generation, so Generations rules (which
+// have age planes) and Larger than Life step the whole board each time.
+internal void
+step_board_blocked(life_board *board, u32 generation_count, memory_arena *scratch_arena)
+{
+    if(board->age_plane_count || board->rule.radius)
+    {
+        for(u32 generation = 0;
+            generation < generation_count;
+            generation += 1)
+        {
+            step_board(board);
+        }
+        return;
+    }
+
+    u32 word_count = (board->grid.columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+
+    while(generation_count)
+    {
+        life_blocked_step step = {};
+        step.board = board;
+        step.generation_count = generation_count;
+        if(step.generation_count > LIFE_MAX_BLOCK_GENERATIONS)
+        {
+            step.generation_count = LIFE_MAX_BLOCK_GENERATIONS;
+        }
+        u32 k = step.generation_count;
+
+        step.halo_words = (k + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+        step.tile_words = (word_count < LIFE_TILE_MAX_WORDS) ? word_count : LIFE_TILE_MAX_WORDS;
+
+        // NOTE(ian): Make the tile as tall as the buffer allows, but never so
+        // short that the halo is more than half of what we load.
+        u32 buffer_words = step.tile_words + 2*step.halo_words;
+        u32 budget_rows = (u32)(LIFE_TILE_BUFFER_BYTES / (sizeof(u64)*buffer_words));
+        step.tile_rows = (budget_rows > 4*k) ? (budget_rows - 2*k) : 2*k;
+        u32 buffer_rows = step.tile_rows + 2*k;
+
+        temporary_memory scratch_memory = begin_temporary_memory(scratch_arena);
+        step.scratch = Push_Array(scratch_arena, board->band_count, life_tile_scratch);
+        for(u32 band_index = 0;
+            band_index < board->band_count;
+            band_index += 1)
+        {
+            // NOTE(ian): Each worker's pair gets its own sub-arena so the
+            // buffers start on their own cache lines and pages.
+            memory_arena worker_arena;
+            platform_memory_block worker_block;
+            u64 buffer_size = (u64)buffer_rows*buffer_words*sizeof(u64);
+            sub_arena(&worker_arena, &worker_block, scratch_arena,
+                      2*buffer_size + ARENA_ROW_ALIGNMENT, LIFE_GRID_ALIGNMENT);
+
+            life_tile_scratch *scratch = step.scratch + band_index;
+            scratch->buffers[0] = (u64 *)Push_Size(&worker_arena, buffer_size, ARENA_ROW_ALIGNMENT);
+            scratch->buffers[1] = (u64 *)Push_Size(&worker_arena, buffer_size, ARENA_ROW_ALIGNMENT);
+        }
+
+        global_platform.run_on_workers(step_band_blocked_work, &step);
+        merge_band_stats(board);
+        end_temporary_memory(scratch_memory);
+
+        life_grid swap = board->grid;
+        board->grid = board->temp_grid;
+        board->temp_grid = swap;
+        board->generation += k;
+
+        generation_count -= k;
+    }
+}
+
+#define LIFE_GRID_H
+#endif
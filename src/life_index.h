@@ -0,0 +1,502 @@
+#ifndef LIFE_INDEX_H
+
+// NOTE(ian): Population index: how many live cells are in any rectangle of
+// the board, in constant time. The board is cut into tiles of
+// LIFE_INDEX_TILE_ROWS rows by one word (64 by 64 cells), and we keep
+//
+//     tile_sums     a summed-area table over whole tiles: live cells above
+//                   and left of each tile corner.
+//     row_strips    per tile row, for each tile column boundary and each row
+//                   offset r: live cells in the first r rows of the tile row,
+//                   left of the boundary.
+//     column_strips the same turned sideways: per tile column, for each tile
+//                   row boundary and column offset c, live cells in the first
+//                   c columns of the tile column, above the boundary.
+//
+// A rectangle splits into at most three spans each way (a partial tile, a
+// run of whole tiles, a partial tile), and the nine pieces are answered by,
+// respectively, four table reads, four strip reads, or (only the four
+// corners, each inside a single tile) at most 64 masked popcounts.
+//
+// Updates are incremental. The step kernels flag each tile they change in
+// board->changed_tiles, and update_population_index only recounts those
+// tiles and re-accumulates the strips from the first changed tile onwards.
+// The summed-area table is a tile-level pass, which is 4096 times smaller
+// than the grid, so it's simply rebuilt.
+//
+// The strips cost about as much memory as the grid itself, which is why the
+// index is something you attach to a board rather than part of it.
+
+#define LIFE_INDEX_STRIP_COUNT (LIFE_INDEX_TILE_ROWS + 1)
+
+struct life_population_index
+{
+    life_board *board;
+    u64 generation; // NOTE(ian): of the board at the last update
+
+    u32 tile_rows;
+    u32 tile_columns;
+
+    u64 *tile_sums;     // NOTE(ian): (tile_rows + 1) x (tile_columns + 1)
+    u32 *row_strips;    // NOTE(ian): tile_rows x (tile_columns + 1) x LIFE_INDEX_STRIP_COUNT
+    u32 *column_strips; // NOTE(ian): tile_columns x (tile_rows + 1) x LIFE_INDEX_STRIP_COUNT
+};
+
+inline u64 *
+get_tile_sum(life_population_index *index, u32 tile_row, u32 tile_column)
+{
+    u64 *result = index->tile_sums + (u64)tile_row*(index->tile_columns + 1) + tile_column;
+    return(result);
+}
+
+inline u32 *
+get_row_strip(life_population_index *index, u32 tile_row, u32 tile_column)
+{
+    u32 *result = (index->row_strips +
+                   ((u64)tile_row*(index->tile_columns + 1) + tile_column)*LIFE_INDEX_STRIP_COUNT);
+    return(result);
+}
+
+inline u32 *
+get_column_strip(life_population_index *index, u32 tile_column, u32 tile_row)
+{
+    u32 *result = (index->column_strips +
+                   ((u64)tile_column*(index->tile_rows + 1) + tile_row)*LIFE_INDEX_STRIP_COUNT);
+    return(result);
+}
+
+inline u8 *
+get_changed_tile(life_board *board, u32 tile_row, u32 tile_column)
+{
+    u32 word_count = (board->grid.columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    u8 *result = board->changed_tiles + (u64)tile_row*word_count + tile_column;
+    return(result);
+}
+
+// NOTE(ian): prefix[r] is the number of live cells in the tile's first r rows.
+// Rows past the bottom of the board count as empty.
+internal void
+get_tile_row_prefix(life_grid *grid, u32 tile_row, u32 tile_column, u32 *prefix)
+{
+    u32 first_row = tile_row*LIFE_INDEX_TILE_ROWS;
+    u32 sum = 0;
+    prefix[0] = 0;
+    for(u32 offset = 0;
+        offset < LIFE_INDEX_TILE_ROWS;
+        offset += 1)
+    {
+        if(first_row + offset < grid->rows)
+        {
+            sum += count_set_bits(get_grid_row(grid, first_row + offset)[tile_column]);
+        }
+        prefix[offset + 1] = sum;
+    }
+}
+
+// NOTE(ian): prefix[c] is the number of live cells in the tile's first c
+// columns. The column counts come out of a bit-sliced counter: each row is
+// added into seven bit planes (64 needs seven bits) with a ripple carry, so
+// all 64 columns are counted at once.
+internal void
+get_tile_column_prefix(life_grid *grid, u32 tile_row, u32 tile_column, u32 *prefix)
+{
+    u32 first_row = tile_row*LIFE_INDEX_TILE_ROWS;
+    u32 end_row = first_row + LIFE_INDEX_TILE_ROWS;
+    if(end_row > grid->rows)
+    {
+        end_row = grid->rows;
+    }
+
+    u32 plane_count = 7;
+    u64 planes[7] = {};
+    for(u32 row = first_row;
+        row < end_row;
+        row += 1)
+    {
+        u64 carry = get_grid_row(grid, row)[tile_column];
+        for(u32 plane = 0;
+            plane < plane_count;
+            plane += 1)
+        {
+            u64 sum = planes[plane] ^ carry;
+            carry &= planes[plane];
+            planes[plane] = sum;
+        }
+    }
+
+    u32 sum = 0;
+    prefix[0] = 0;
+    for(u32 column = 0;
+        column < LIFE_WORD_BITS;
+        column += 1)
+    {
+        for(u32 plane = 0;
+            plane < plane_count;
+            plane += 1)
+        {
+            sum += (u32)((planes[plane] >> column) & 1) << plane;
+        }
+        prefix[column + 1] = sum;
+    }
+}
+
+// NOTE(ian): Re-accumulates the row strips of one tile row, starting at its
+// first changed tile. Unchanged tiles still need adding in past that point;
+// their own counts are the difference of their two old strips, which we read
+// just before overwriting them.
+internal void
+update_row_strips(life_population_index *index, u32 tile_row)
+{
+    life_board *board = index->board;
+    u32 first_changed = index->tile_columns;
+    for(u32 tile_column = 0;
+        tile_column < index->tile_columns;
+        tile_column += 1)
+    {
+        if(*get_changed_tile(board, tile_row, tile_column))
+        {
+            first_changed = tile_column;
+            break;
+        }
+    }
+
+    u32 old_left[LIFE_INDEX_STRIP_COUNT];
+    u32 *left = get_row_strip(index, tile_row, first_changed);
+    memcpy(old_left, left, sizeof(old_left));
+
+    for(u32 tile_column = first_changed;
+        tile_column < index->tile_columns;
+        tile_column += 1)
+    {
+        u32 *right = get_row_strip(index, tile_row, tile_column + 1);
+        u32 tile[LIFE_INDEX_STRIP_COUNT];
+        if(*get_changed_tile(board, tile_row, tile_column))
+        {
+            get_tile_row_prefix(&board->grid, tile_row, tile_column, tile);
+        }
+        else
+        {
+            for(u32 offset = 0;
+                offset < LIFE_INDEX_STRIP_COUNT;
+                offset += 1)
+            {
+                tile[offset] = right[offset] - old_left[offset];
+            }
+        }
+
+        for(u32 offset = 0;
+            offset < LIFE_INDEX_STRIP_COUNT;
+            offset += 1)
+        {
+            old_left[offset] = right[offset];
+            right[offset] = left[offset] + tile[offset];
+        }
+        left = right;
+    }
+}
+
+// NOTE(ian): Same as update_row_strips, down one tile column. Clears the
+// column's change flags as it goes, so this has to come after the row strips.
+internal void
+update_column_strips(life_population_index *index, u32 tile_column)
+{
+    life_board *board = index->board;
+    u32 first_changed = index->tile_rows;
+    for(u32 tile_row = 0;
+        tile_row < index->tile_rows;
+        tile_row += 1)
+    {
+        if(*get_changed_tile(board, tile_row, tile_column))
+        {
+            first_changed = tile_row;
+            break;
+        }
+    }
+
+    u32 old_above[LIFE_INDEX_STRIP_COUNT];
+    u32 *above = get_column_strip(index, tile_column, first_changed);
+    memcpy(old_above, above, sizeof(old_above));
+
+    for(u32 tile_row = first_changed;
+        tile_row < index->tile_rows;
+        tile_row += 1)
+    {
+        u32 *below = get_column_strip(index, tile_column, tile_row + 1);
+        u8 *changed = get_changed_tile(board, tile_row, tile_column);
+        u32 tile[LIFE_INDEX_STRIP_COUNT];
+        if(*changed)
+        {
+            get_tile_column_prefix(&board->grid, tile_row, tile_column, tile);
+            *changed = 0;
+        }
+        else
+        {
+            for(u32 offset = 0;
+                offset < LIFE_INDEX_STRIP_COUNT;
+                offset += 1)
+            {
+                tile[offset] = below[offset] - old_above[offset];
+            }
+        }
+
+        for(u32 offset = 0;
+            offset < LIFE_INDEX_STRIP_COUNT;
+            offset += 1)
+        {
+            old_above[offset] = below[offset];
+            below[offset] = above[offset] + tile[offset];
+        }
+        above = below;
+    }
+}
+
+// NOTE(ian): Each band owns whole tile rows (see LIFE_INDEX_TILE_ROWS).
+internal
+PLATFORM_WORK_CALLBACK(update_row_strips_work)
+{
+    life_population_index *index = (life_population_index *)data;
+    life_board *board = index->board;
+    if(worker_index < board->band_count)
+    {
+        life_band *band = board->bands + worker_index;
+        u32 first_tile_row = band->first_row / LIFE_INDEX_TILE_ROWS;
+        u32 end_tile_row = (band->end_row + LIFE_INDEX_TILE_ROWS - 1) / LIFE_INDEX_TILE_ROWS;
+        for(u32 tile_row = first_tile_row;
+            tile_row < end_tile_row;
+            tile_row += 1)
+        {
+            update_row_strips(index, tile_row);
+        }
+    }
+}
+
+// NOTE(ian): The columns (including the one past the last tile, which only
+// has a tile_sums column) are dealt out to the workers in even runs.
+internal
+PLATFORM_WORK_CALLBACK(update_column_strips_work)
+{
+    life_population_index *index = (life_population_index *)data;
+    life_board *board = index->board;
+    if(worker_index < board->band_count)
+    {
+        u32 column_count = index->tile_columns + 1;
+        u32 columns_per_worker = (column_count + board->band_count - 1) / board->band_count;
+        u32 first_column = worker_index*columns_per_worker;
+        u32 end_column = first_column + columns_per_worker;
+        if(end_column > column_count)
+        {
+            end_column = column_count;
+        }
+
+        for(u32 tile_column = first_column;
+            tile_column < end_column;
+            tile_column += 1)
+        {
+            // NOTE(ian): The row strips' last entry is the whole tile row left
+            // of this column, so the summed-area column is a running total of
+            // those.
+            u64 sum = 0;
+            *get_tile_sum(index, 0, tile_column) = 0;
+            for(u32 tile_row = 0;
+                tile_row < index->tile_rows;
+                tile_row += 1)
+            {
+                sum += get_row_strip(index, tile_row, tile_column)[LIFE_INDEX_TILE_ROWS];
+                *get_tile_sum(index, tile_row + 1, tile_column) = sum;
+            }
+
+            if(tile_column < index->tile_columns)
+            {
+                update_column_strips(index, tile_column);
+            }
+        }
+    }
+}
+
+// NOTE(ian): Brings the index up to date with the board. Call it after
+// stepping (any number of generations, blocked or not) and before querying.
+internal void
+update_population_index(life_population_index *index)
+{
+    global_platform.run_on_workers(update_row_strips_work, index);
+    global_platform.run_on_workers(update_column_strips_work, index);
+    index->generation = index->board->generation;
+}
+
+// NOTE(ian): For cells changed by hand rather than by a step. Rows and
+// columns are half-open, and a no-op when nothing is attached.
+internal void
+mark_population_index_changed(life_board *board, u32 first_row, u32 first_column,
+                              u32 end_row, u32 end_column)
+{
+    if(board->changed_tiles && first_row < end_row && first_column < end_column)
+    {
+        for(u32 tile_row = first_row / LIFE_INDEX_TILE_ROWS;
+            tile_row <= (end_row - 1) / LIFE_INDEX_TILE_ROWS;
+            tile_row += 1)
+        {
+            for(u32 tile_column = first_column / LIFE_WORD_BITS;
+                tile_column <= (end_column - 1) / LIFE_WORD_BITS;
+                tile_column += 1)
+            {
+                *get_changed_tile(board, tile_row, tile_column) = 1;
+            }
+        }
+    }
+}
+
+// NOTE(ian): From now on the board's kernels flag the tiles they change for
+// this index. The index starts out up to date.
+internal void
+attach_population_index(life_population_index *index, life_board *board, memory_arena *arena)
+{
+    life_grid *grid = &board->grid;
+    index->board = board;
+    index->tile_rows = (grid->rows + LIFE_INDEX_TILE_ROWS - 1) / LIFE_INDEX_TILE_ROWS;
+    index->tile_columns = (grid->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+
+    u64 tile_count = (u64)index->tile_rows*index->tile_columns;
+    index->tile_sums = Push_Array(arena, (u64)(index->tile_rows + 1)*(index->tile_columns + 1), u64);
+    index->row_strips = Push_Array(arena, (u64)index->tile_rows*(index->tile_columns + 1)*LIFE_INDEX_STRIP_COUNT,
+                                   u32, LIFE_GRID_ALIGNMENT);
+    index->column_strips = Push_Array(arena, (u64)index->tile_columns*(index->tile_rows + 1)*LIFE_INDEX_STRIP_COUNT,
+                                      u32, LIFE_GRID_ALIGNMENT);
+
+    // NOTE(ian): Everything accumulates from the zero strips along the top and
+    // left edges, which updates never write.
+    for(u32 tile_row = 0;
+        tile_row < index->tile_rows;
+        tile_row += 1)
+    {
+        memset(get_row_strip(index, tile_row, 0), 0, LIFE_INDEX_STRIP_COUNT*sizeof(u32));
+    }
+    for(u32 tile_column = 0;
+        tile_column < index->tile_columns;
+        tile_column += 1)
+    {
+        memset(get_column_strip(index, tile_column, 0), 0, LIFE_INDEX_STRIP_COUNT*sizeof(u32));
+    }
+
+    board->changed_tiles = Push_Array(arena, tile_count, u8);
+    memset(board->changed_tiles, 1, tile_count);
+    update_population_index(index);
+}
+
+// NOTE(ian): A run of cells along one axis, cut at tile boundaries. Either
+// whole tiles [first_tile, end_tile), or cells [first_offset, end_offset) of
+// tile first_tile.
+struct life_index_span
+{
+    bool32 whole;
+    u32 first_tile;
+    u32 end_tile;
+    u32 first_offset;
+    u32 end_offset;
+};
+
+internal u32
+split_index_span(u32 first, u32 end, u32 tile_size, life_index_span *spans)
+{
+    u32 span_count = 0;
+    while(first < end)
+    {
+        life_index_span *span = spans + span_count++;
+        u32 tile = first / tile_size;
+        u32 offset = first % tile_size;
+        if(offset == 0 && end - first >= tile_size)
+        {
+            span->whole = true;
+            span->first_tile = tile;
+            span->end_tile = end / tile_size;
+            first = span->end_tile*tile_size;
+        }
+        else
+        {
+            span->whole = false;
+            span->first_tile = tile;
+            span->end_tile = tile + 1;
+            span->first_offset = offset;
+            span->end_offset = (end - tile*tile_size < tile_size) ? (end - tile*tile_size) : tile_size;
+            first = tile*tile_size + span->end_offset;
+        }
+    }
+    Assert(span_count <= 3);
+    return(span_count);
+}
+
+// NOTE(ian): Live cells in rows [first_row, end_row) and columns
+// [first_column, end_column), clipped to the board.
+internal u64
+count_live_cells(life_population_index *index, u32 first_row, u32 first_column,
+                 u32 end_row, u32 end_column)
+{
+    life_grid *grid = &index->board->grid;
+    Assert(index->generation == index->board->generation);
+    if(end_row > grid->rows)
+    {
+        end_row = grid->rows;
+    }
+    if(end_column > grid->columns)
+    {
+        end_column = grid->columns;
+    }
+
+    life_index_span row_spans[3];
+    life_index_span column_spans[3];
+    u32 row_span_count = split_index_span(first_row, end_row, LIFE_INDEX_TILE_ROWS, row_spans);
+    u32 column_span_count = split_index_span(first_column, end_column, LIFE_WORD_BITS, column_spans);
+
+    u64 result = 0;
+    for(u32 row_span_index = 0;
+        row_span_index < row_span_count;
+        row_span_index += 1)
+    {
+        life_index_span *rows = row_spans + row_span_index;
+        for(u32 column_span_index = 0;
+            column_span_index < column_span_count;
+            column_span_index += 1)
+        {
+            life_index_span *columns = column_spans + column_span_index;
+            if(rows->whole && columns->whole)
+            {
+                result += (*get_tile_sum(index, rows->end_tile, columns->end_tile) -
+                           *get_tile_sum(index, rows->first_tile, columns->end_tile) -
+                           *get_tile_sum(index, rows->end_tile, columns->first_tile) +
+                           *get_tile_sum(index, rows->first_tile, columns->first_tile));
+            }
+            else if(columns->whole)
+            {
+                u32 *right = get_row_strip(index, rows->first_tile, columns->end_tile);
+                u32 *left = get_row_strip(index, rows->first_tile, columns->first_tile);
+                result += ((right[rows->end_offset] - right[rows->first_offset]) -
+                           (left[rows->end_offset] - left[rows->first_offset]));
+            }
+            else if(rows->whole)
+            {
+                u32 *below = get_column_strip(index, columns->first_tile, rows->end_tile);
+                u32 *above = get_column_strip(index, columns->first_tile, rows->first_tile);
+                result += ((below[columns->end_offset] - below[columns->first_offset]) -
+                           (above[columns->end_offset] - above[columns->first_offset]));
+            }
+            else
+            {
+                u64 mask = ~0ULL << columns->first_offset;
+                if(columns->end_offset < LIFE_WORD_BITS)
+                {
+                    mask &= (1ULL << columns->end_offset) - 1;
+                }
+                u32 tile_first_row = rows->first_tile*LIFE_INDEX_TILE_ROWS;
+                for(u32 row = tile_first_row + rows->first_offset;
+                    row < tile_first_row + rows->end_offset;
+                    row += 1)
+                {
+                    result += count_set_bits(get_grid_row(grid, row)[columns->first_tile] & mask);
+                }
+            }
+        }
+    }
+    return(result);
+}
+
+#define LIFE_INDEX_H
+#endif
@@ -0,0 +1,78 @@
+#ifndef LIFE_INTRINSICS_H
+
+// NOTE(ian): Bit twiddling the compilers have instructions for. Everything
+// here is on a 64-bit word of packed cells.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline u32
+count_set_bits(u64 value)
+{
+#if defined(_MSC_VER)
+    u32 result = (u32)__popcnt64(value);
+#else
+    u32 result = (u32)__builtin_popcountll(value);
+#endif
+    return(result);
+}
+
+// NOTE(ian): value must not be zero.
+inline u32
+find_lowest_set_bit(u64 value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    u32 result = (u32)index;
+#else
+    u32 result = (u32)__builtin_ctzll(value);
+#endif
+    return(result);
+}
+
+// NOTE(ian): value must not be zero.
+inline u32
+find_highest_set_bit(u64 value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    u32 result = (u32)index;
+#else
+    u32 result = 63 - (u32)__builtin_clzll(value);
+#endif
+    return(result);
+}
+
+inline u64
+rotate_left(u64 value, u32 shift)
+{
+#if defined(_MSC_VER)
+    u64 result = _rotl64(value, (int)shift);
+#else
+    // NOTE(ian): GCC and Clang turn this into a single rol.
+    u64 result = (value << shift) | (value >> ((64 - shift) & 63));
+#endif
+    return(result);
+}
+
+// NOTE(ian): Mirrors a word end for end; no x64 instruction for this one, so
+// it's the usual swap of ever smaller halves.
+inline u64
+reverse_bits(u64 value)
+{
+    value = ((value >> 1) & 0x5555555555555555ULL) | ((value & 0x5555555555555555ULL) << 1);
+    value = ((value >> 2) & 0x3333333333333333ULL) | ((value & 0x3333333333333333ULL) << 2);
+    value = ((value >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((value & 0x0F0F0F0F0F0F0F0FULL) << 4);
+#if defined(_MSC_VER)
+    u64 result = _byteswap_uint64(value);
+#else
+    u64 result = __builtin_bswap64(value);
+#endif
+    return(result);
+}
+
+#define LIFE_INTRINSICS_H
+#endif
@@ -0,0 +1,250 @@
+#ifndef LIFE_MEMORY_H
+
+// NOTE(ian): A memory_arena is a chain of platform_memory_blocks. Each block
+// reserves a big range of address space up front and only commits pages as
+// pushes reach them, so reserving generously is cheap. When the current block
+// is full we chain a new one instead of asserting, which means a pointer you
+// got from the arena never moves.
+//
+// Nothing here clears memory for you. Freshly committed pages come back
+// zeroed from the OS, but anything recycled through temporary memory or
+// clear_arena will still hold whatever was there before.
+
+#define ARENA_DEFAULT_ALIGNMENT 16
+// NOTE(ian): One cache line, which also covers the widest SIMD registers we
+// care about (AVX-512), so grid rows pushed with this never split a load.
+#define ARENA_ROW_ALIGNMENT 64
+
+// NOTE(ian): Set on blocks that belong to a sub_arena rather than the platform.
+#define ARENA_BLOCK_FIXED (1ULL << 63)
+
+struct memory_arena
+{
+    platform_memory_block *current_block;
+    u64 minimum_block_size;
+    u64 allocation_flags;
+    s32 temp_count;
+
+    u64 used; // NOTE(ian): live bytes across every block, padding included
+    u64 high_water_mark;
+};
+
+struct temporary_memory
+{
+    memory_arena *arena;
+    platform_memory_block *block;
+    u64 used;
+};
+
+struct arena_stats
+{
+    u32 block_count;
+    u64 used;
+    u64 high_water_mark;
+    u64 committed;
+    u64 reserved;
+};
+
+inline void
+initialize_arena(memory_arena *arena, u64 minimum_block_size, u64 allocation_flags = 0)
+{
+    arena->current_block = 0;
+    arena->minimum_block_size = minimum_block_size;
+    arena->allocation_flags = allocation_flags;
+    arena->temp_count = 0;
+    arena->used = 0;
+    arena->high_water_mark = 0;
+}
+
+inline u64
+get_alignment_offset(platform_memory_block *block, u64 alignment)
+{
+    Assert((alignment & (alignment - 1)) == 0);
+
+    u64 result = 0;
+    u64 pointer = (u64)(block->base + block->used);
+    u64 alignment_mask = alignment - 1;
+    if(pointer & alignment_mask)
+    {
+        result = alignment - (pointer & alignment_mask);
+    }
+    return(result);
+}
+
+#define Push_Struct(arena, type, ...) (type *)_push_size(arena, sizeof(type), ## __VA_ARGS__)
+#define Push_Array(arena, count, type, ...) (type *)_push_size(arena, (count)*sizeof(type), ## __VA_ARGS__)
+#define Push_Size(arena, size, ...) _push_size(arena, size, ## __VA_ARGS__)
+internal void *
+_push_size(memory_arena *arena, u64 size, u64 alignment = ARENA_DEFAULT_ALIGNMENT)
+{
+    platform_memory_block *block = arena->current_block;
+    u64 alignment_offset = 0;
+    if(block)
+    {
+        alignment_offset = get_alignment_offset(block, alignment);
+    }
+
+    if(!block || (block->used + alignment_offset + size) > block->size)
+    {
+        Assert(!block || !(block->flags & ARENA_BLOCK_FIXED));
+
+        // NOTE(ian): Whatever is left at the end of the old block is simply
+        // abandoned; it comes back when the arena is cleared or a temporary
+        // memory scope that started before the new block ends.
+        u64 block_size = size + alignment;
+        if(block_size < arena->minimum_block_size)
+        {
+            block_size = arena->minimum_block_size;
+        }
+
+        platform_memory_block *new_block = global_platform.allocate_memory(block_size,
+                                                                           arena->allocation_flags);
+        Assert(new_block);
+        new_block->prev = block;
+        arena->current_block = new_block;
+
+        block = new_block;
+        alignment_offset = get_alignment_offset(block, alignment);
+    }
+
+    u64 new_used = block->used + alignment_offset + size;
+    Assert(new_used <= block->size);
+    if(new_used > block->committed)
+    {
+        bool32 committed = global_platform.commit_memory(block, new_used);
+        Assert(committed);
+    }
+
+    void *result = block->base + block->used + alignment_offset;
+    block->used = new_used;
+
+    arena->used += alignment_offset + size;
+    if(arena->used > arena->high_water_mark)
+    {
+        arena->high_water_mark = arena->used;
+    }
+
+    return(result);
+}
+
+internal void
+free_last_block(memory_arena *arena)
+{
+    platform_memory_block *free = arena->current_block;
+    arena->used -= free->used;
+    arena->current_block = free->prev;
+    global_platform.deallocate_memory(free);
+}
+
+// NOTE(ian): Frees every block but the first, and keeps the first block's
+// committed pages around so a reset doesn't have to fault them all back in.
+internal void
+clear_arena(memory_arena *arena)
+{
+    Assert(arena->temp_count == 0);
+    if(arena->current_block)
+    {
+        while(arena->current_block->prev)
+        {
+            free_last_block(arena);
+        }
+        arena->current_block->used = 0;
+    }
+    arena->used = 0;
+}
+
+// NOTE(ian): Gives every block back to the platform, the first one too.
+internal void
+free_arena(memory_arena *arena)
+{
+    Assert(arena->temp_count == 0);
+    while(arena->current_block)
+    {
+        free_last_block(arena);
+    }
+    arena->used = 0;
+}
+
+internal temporary_memory
+begin_temporary_memory(memory_arena *arena)
+{
+    temporary_memory result;
+
+    result.arena = arena;
+    result.block = arena->current_block;
+    result.used = arena->current_block ? arena->current_block->used : 0;
+
+    arena->temp_count += 1;
+
+    return(result);
+}
+
+internal void
+end_temporary_memory(temporary_memory temp)
+{
+    memory_arena *arena = temp.arena;
+    while(arena->current_block != temp.block)
+    {
+        // NOTE(ian): Like clear_arena, hang on to the arena's first block so
+        // per-generation scratch doesn't map and unmap a block every frame.
+        if(!temp.block && !arena->current_block->prev)
+        {
+            break;
+        }
+        free_last_block(arena);
+    }
+
+    if(arena->current_block)
+    {
+        Assert(arena->current_block->used >= temp.used);
+        arena->used -= arena->current_block->used - temp.used;
+        arena->current_block->used = temp.used;
+    }
+
+    Assert(arena->temp_count > 0);
+    arena->temp_count -= 1;
+}
+
+inline void
+check_arena(memory_arena *arena)
+{
+    Assert(arena->temp_count == 0);
+}
+
+// NOTE(ian): Carves a fixed-size arena out of a parent. The sub-arena can't
+// grow, so size it for the worst case. Handy for handing each worker its own
+// scratch space out of one temporary_memory scope on the parent.
+internal void
+sub_arena(memory_arena *result, platform_memory_block *result_block,
+          memory_arena *parent, u64 size, u64 alignment = ARENA_ROW_ALIGNMENT)
+{
+    result_block->flags = ARENA_BLOCK_FIXED;
+    result_block->size = size;
+    result_block->committed = size;
+    result_block->used = 0;
+    result_block->base = (u8 *)_push_size(parent, size, alignment);
+    result_block->prev = 0;
+
+    initialize_arena(result, 0, parent->allocation_flags);
+    result->current_block = result_block;
+}
+
+internal arena_stats
+get_arena_stats(memory_arena *arena)
+{
+    arena_stats result = {};
+    result.used = arena->used;
+    result.high_water_mark = arena->high_water_mark;
+    for(platform_memory_block *block = arena->current_block;
+        block;
+        block = block->prev)
+    {
+        result.block_count += 1;
+        result.committed += block->committed;
+        result.reserved += block->size;
+    }
+    return(result);
+}
+
+#define LIFE_MEMORY_H
+#endif
@@ -0,0 +1,204 @@
+#ifndef LIFE_RECORD_H
+
+// NOTE(ian): Recordings are a life_record_header followed by one
+// life_snapshot_header + payload per recorded generation. A snapshot is the
+// grid's rows packed back to back (no row padding), stored either whole
+// (a keyframe) or XORed against the snapshot before it. Either way the words
+// are then run-length coded: most words of a delta are zero, and so are most
+// words of a typical board.
+//
+// Payload layout, repeated until the words run out:
+//     varint  number of zero words
+//     varint  number of literal words that follow
+//     u64[]   the literal words
+//
+// Keyframes come every keyframe_interval snapshots so a reader can seek.
+
+#define LIFE_RECORD_MAGIC 0x5246494C   // "LIFR"
+#define LIFE_SNAPSHOT_MAGIC 0x50414E53 // "SNAP"
+#define LIFE_RECORD_VERSION 1
+
+enum life_snapshot_flags
+{
+    Life_Snapshot_Keyframe = 0x1,
+};
+
+struct life_record_header
+{
+    u32 magic;
+    u32 version;
+    u32 rows;
+    u32 columns;
+    u32 interval;          // NOTE(ian): generations between snapshots
+    u32 keyframe_interval; // NOTE(ian): snapshots between keyframes
+};
+
+struct life_snapshot_header
+{
+    u32 magic;
+    u32 flags;
+    u64 generation;
+    u64 size; // NOTE(ian): payload bytes after this header
+};
+
+inline u64
+get_snapshot_word_count(u32 rows, u32 columns)
+{
+    u64 result = (u64)rows*((columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS);
+    return(result);
+}
+
+// NOTE(ian): Worst case is alternating zero and nonzero words: two one-byte
+// varints per literal word.
+inline u64
+get_max_encoded_snapshot_size(u64 word_count)
+{
+    u64 result = word_count*(sizeof(u64) + 2) + 2*10;
+    return(result);
+}
+
+inline u8 *
+write_varint(u8 *out, u64 value)
+{
+    while(value >= 0x80)
+    {
+        *out++ = (u8)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (u8)value;
+    return(out);
+}
+
+inline u8 *
+read_varint(u8 *in, u8 *end, u64 *value)
+{
+    u64 result = 0;
+    u32 shift = 0;
+    while(in < end && shift < 64)
+    {
+        u8 byte = *in++;
+        result |= (u64)(byte & 0x7F) << shift;
+        shift += 7;
+        if(!(byte & 0x80))
+        {
+            *value = result;
+            return(in);
+        }
+    }
+    return(0);
+}
+
+// NOTE(ian): Copies the grid into snapshot, rows back to back. This is the
+// only part of recording that runs on the simulation thread.
+internal void
+copy_grid_snapshot(life_grid *grid, u64 *snapshot)
+{
+    u32 word_count = (grid->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    if(word_count == grid->words_per_row)
+    {
+        memcpy(snapshot, grid->words, (u64)grid->rows*word_count*sizeof(u64));
+    }
+    else
+    {
+        for(u32 row = 0;
+            row < grid->rows;
+            row += 1)
+        {
+            memcpy(snapshot + (u64)row*word_count, get_grid_row(grid, row),
+                   word_count*sizeof(u64));
+        }
+    }
+}
+
+// NOTE(ian): Pass previous = 0 for a keyframe. out must have room for
+// get_max_encoded_snapshot_size(word_count) bytes. Returns the payload size.
+internal u64
+encode_snapshot(u64 *words, u64 *previous, u64 word_count, u8 *out)
+{
+    u8 *at = out;
+    u64 index = 0;
+    while(index < word_count)
+    {
+        u64 zero_start = index;
+        while(index < word_count &&
+              (words[index] ^ (previous ? previous[index] : 0)) == 0)
+        {
+            index += 1;
+        }
+
+        u64 literal_start = index;
+        while(index < word_count &&
+              (words[index] ^ (previous ? previous[index] : 0)) != 0)
+        {
+            index += 1;
+        }
+
+        at = write_varint(at, literal_start - zero_start);
+        at = write_varint(at, index - literal_start);
+        for(u64 literal = literal_start;
+            literal < index;
+            literal += 1)
+        {
+            u64 word = words[literal] ^ (previous ? previous[literal] : 0);
+            memcpy(at, &word, sizeof(word));
+            at += sizeof(word);
+        }
+    }
+
+    u64 result = (u64)(at - out);
+    return(result);
+}
+
+// NOTE(ian): words holds the previous snapshot on the way in (ignored for a
+// keyframe) and the decoded one on the way out.
+internal bool32
+decode_snapshot(u8 *in, u64 size, bool32 keyframe, u64 *words, u64 word_count)
+{
+    u8 *end = in + size;
+    u64 index = 0;
+    while(in && in < end)
+    {
+        u64 zero_count;
+        u64 literal_count;
+        in = read_varint(in, end, &zero_count);
+        if(in)
+        {
+            in = read_varint(in, end, &literal_count);
+        }
+        if(!in ||
+           zero_count > word_count - index ||
+           literal_count > word_count - index - zero_count ||
+           literal_count*sizeof(u64) > (u64)(end - in))
+        {
+            return(false);
+        }
+
+        if(keyframe)
+        {
+            for(u64 zero = 0;
+                zero < zero_count;
+                zero += 1)
+            {
+                words[index + zero] = 0;
+            }
+        }
+        index += zero_count;
+
+        for(u64 literal = 0;
+            literal < literal_count;
+            literal += 1)
+        {
+            u64 word;
+            memcpy(&word, in, sizeof(word));
+            in += sizeof(word);
+            words[index] = keyframe ? word : (words[index] ^ word);
+            index += 1;
+        }
+    }
+
+    bool32 result = (in == end) && (index == word_count);
+    return(result);
+}
+
+#define LIFE_RECORD_H
+#endif
@@ -0,0 +1,370 @@
+#ifndef LIFE_RULE_H
+
+// NOTE(ian): A rule says which neighbour counts give birth to a dead cell and
+// which keep a live one alive; birth and survive are bit masks over the count
+// (bit n set means n live neighbours).
+//
+// Cells have state_count states. 0 is dead and 1 is alive. Anything above that
+// is "dying", as in the Generations rules (Brian's Brain, Star Wars): a live
+// cell that doesn't survive moves to state 2, a dying cell ignores its
+// neighbours and moves up one state per generation, and after the last state
+// it's dead. Only live cells count as neighbours. state_count 2 is an
+// ordinary life-like rule.
+//
+// Larger than Life rules look further: every cell within radius (in the
+// Moore square or the von Neumann diamond) counts, optionally the cell itself
+// too, and birth and survival are count intervals instead of masks. A zero
+// radius means the ordinary eight-neighbour rule and its masks.
+//
+// Accepted notations:
+//     B3/S23, B2/S/C3      birth/survive, optionally /Cn (or /Gn) states
+//     23/3, /2/3, 345/2/4  survive/birth/states, as in MCell and Golly
+//     R5,C0,M1,S34..58,B34..45,NM
+//                          Larger than Life as Golly writes it: radius,
+//                          states (0 and 2 both mean two), M1 to count the
+//                          cell itself, and NM or NN for Moore or von Neumann
+
+#define LIFE_MAX_NEIGHBOR_COUNT 8
+#define LIFE_MAX_STATES 256
+#define LIFE_MAX_AGE_PLANES 8
+#define LIFE_MAX_RADIUS 16
+
+enum life_neighborhood
+{
+    Life_Neighborhood_Moore,
+    Life_Neighborhood_Von_Neumann,
+};
+
+struct life_rule
+{
+    u32 birth;
+    u32 survive;
+    u32 state_count;
+
+    // NOTE(ian): Larger than Life only.
+    u32 radius;
+    life_neighborhood neighborhood;
+    bool32 include_center;
+    u32 birth_min;
+    u32 birth_max;
+    u32 survive_min;
+    u32 survive_max;
+};
+
+inline life_rule
+get_conway_rule(void)
+{
+    life_rule result = {};
+    result.birth = (1 << 3);
+    result.survive = (1 << 2) | (1 << 3);
+    result.state_count = 2;
+    return(result);
+}
+
+inline bool32
+is_conway_rule(life_rule *rule)
+{
+    life_rule conway = get_conway_rule();
+    bool32 result = (rule->radius == 0 &&
+                     rule->birth == conway.birth &&
+                     rule->survive == conway.survive &&
+                     rule->state_count == conway.state_count);
+    return(result);
+}
+
+// NOTE(ian): Dying cells keep their age (state - 1) in binary across this many
+// bit planes. The oldest age is state_count - 2.
+inline u32
+get_age_plane_count(u32 state_count)
+{
+    u32 result = 0;
+    if(state_count > 2)
+    {
+        u32 oldest_age = state_count - 2;
+        while(oldest_age)
+        {
+            result += 1;
+            oldest_age >>= 1;
+        }
+    }
+    return(result);
+}
+
+internal char *
+parse_neighbor_counts(char *at, u32 *mask)
+{
+    *mask = 0;
+    while(*at >= '0' && *at <= '9')
+    {
+        u32 count = (u32)(*at - '0');
+        if(count > LIFE_MAX_NEIGHBOR_COUNT)
+        {
+            return(0);
+        }
+        *mask |= (1 << count);
+        at += 1;
+    }
+    return(at);
+}
+
+internal char *
+parse_state_count(char *at, u32 *state_count)
+{
+    *state_count = 0;
+    while(*at >= '0' && *at <= '9' && *state_count <= LIFE_MAX_STATES)
+    {
+        *state_count = *state_count*10 + (u32)(*at - '0');
+        at += 1;
+    }
+    return(at);
+}
+
+// NOTE(ian): Cells in the neighbourhood, counting the center.
+inline u32
+get_max_range_count(u32 radius, life_neighborhood neighborhood)
+{
+    u32 side = 2*radius + 1;
+    u32 result = side*side;
+    if(neighborhood == Life_Neighborhood_Von_Neumann)
+    {
+        result = 2*radius*(radius + 1) + 1;
+    }
+    return(result);
+}
+
+internal char *
+parse_count_interval(char *at, u32 *min, u32 *max)
+{
+    char *end;
+    *min = (u32)strtoul(at, &end, 10);
+    if(end == at || end[0] != '.' || end[1] != '.')
+    {
+        return(0);
+    }
+    at = end + 2;
+    *max = (u32)strtoul(at, &end, 10);
+    if(end == at)
+    {
+        return(0);
+    }
+    return(end);
+}
+
+internal bool32
+parse_range_rule(char *text, life_rule *rule)
+{
+    life_rule result = {};
+    result.state_count = 2;
+    result.birth_min = 1;
+    result.birth_max = 0;
+    result.survive_min = 1;
+    result.survive_max = 0;
+
+    char *at = text;
+    while(at && *at)
+    {
+        char letter = *at++;
+        char *end = at;
+        if(letter == 'R' || letter == 'r')
+        {
+            result.radius = (u32)strtoul(at, &end, 10);
+        }
+        else if(letter == 'C' || letter == 'c')
+        {
+            result.state_count = (u32)strtoul(at, &end, 10);
+            if(result.state_count == 0)
+            {
+                result.state_count = 2;
+            }
+        }
+        else if(letter == 'M' || letter == 'm')
+        {
+            result.include_center = (u32)strtoul(at, &end, 10);
+        }
+        else if(letter == 'S' || letter == 's')
+        {
+            end = parse_count_interval(at, &result.survive_min, &result.survive_max);
+        }
+        else if(letter == 'B' || letter == 'b')
+        {
+            end = parse_count_interval(at, &result.birth_min, &result.birth_max);
+        }
+        else if(letter == 'N' || letter == 'n')
+        {
+            end = at + 1;
+            if(*at == 'M' || *at == 'm')
+            {
+                result.neighborhood = Life_Neighborhood_Moore;
+            }
+            else if(*at == 'N' || *at == 'n')
+            {
+                result.neighborhood = Life_Neighborhood_Von_Neumann;
+            }
+            else
+            {
+                end = 0;
+            }
+        }
+        else
+        {
+            end = 0;
+        }
+
+        if(end == at)
+        {
+            end = 0;
+        }
+        at = end;
+        if(at && *at == ',')
+        {
+            at += 1;
+        }
+        else if(at && *at)
+        {
+            at = 0;
+        }
+    }
+
+    // NOTE(ian): Same as B0 below: a dead cell with nothing around it must
+    // stay dead. An interval that starts past the most neighbours a cell can
+    // have is a typo, not a rule, though an empty one (min > max, as when B
+    // or S is left out) is fine.
+    bool32 valid = (at &&
+                    result.radius >= 1 && result.radius <= LIFE_MAX_RADIUS &&
+                    result.include_center <= 1 &&
+                    result.birth_min > 0 &&
+                    result.state_count >= 2 &&
+                    result.state_count <= LIFE_MAX_STATES);
+    if(valid)
+    {
+        u32 max_count = (get_max_range_count(result.radius, result.neighborhood) -
+                         (result.include_center ? 0 : 1));
+        valid = ((result.birth_min <= max_count || result.birth_min > result.birth_max) &&
+                 (result.survive_min <= max_count || result.survive_min > result.survive_max));
+    }
+    if(valid)
+    {
+        *rule = result;
+    }
+    return(valid);
+}
+
+internal bool32
+parse_life_rule(char *text, life_rule *rule)
+{
+    if((text[0] == 'R' || text[0] == 'r') && (text[1] >= '0' && text[1] <= '9'))
+    {
+        bool32 result = parse_range_rule(text, rule);
+        return(result);
+    }
+
+    life_rule result = {};
+    result.state_count = 2;
+    char *at = text;
+
+    bool32 lettered = (*at == 'B' || *at == 'b' || *at == 'S' || *at == 's');
+    if(lettered)
+    {
+        while(at && *at)
+        {
+            char letter = *at++;
+            if(letter == 'B' || letter == 'b')
+            {
+                at = parse_neighbor_counts(at, &result.birth);
+            }
+            else if(letter == 'S' || letter == 's')
+            {
+                at = parse_neighbor_counts(at, &result.survive);
+            }
+            else if(letter == 'C' || letter == 'c' || letter == 'G' || letter == 'g')
+            {
+                at = parse_state_count(at, &result.state_count);
+            }
+            else
+            {
+                at = 0;
+            }
+
+            if(at && *at == '/')
+            {
+                at += 1;
+            }
+            else if(at && *at)
+            {
+                at = 0;
+            }
+        }
+    }
+    else
+    {
+        at = parse_neighbor_counts(at, &result.survive);
+        if(at && *at == '/')
+        {
+            at = parse_neighbor_counts(at + 1, &result.birth);
+            if(at && *at == '/')
+            {
+                at = parse_state_count(at + 1, &result.state_count);
+            }
+        }
+        else
+        {
+            at = 0;
+        }
+    }
+
+    // NOTE(ian): B0 would bring the infinite dead plane outside the grid to
+    // life, which our "everything outside is dead" edges can't represent.
+    bool32 valid = (at && *at == 0 &&
+                    !(result.birth & 1) &&
+                    result.state_count >= 2 &&
+                    result.state_count <= LIFE_MAX_STATES);
+    if(valid)
+    {
+        *rule = result;
+    }
+    return(valid);
+}
+
+//
+// NOTE(ian): Matching a bit-sliced count (see count_neighbors) against a mask.
+//
+
+// NOTE(ian): Expands a count mask into one all-ones or all-zeros word per
+// count, so matching doesn't need to branch.
+inline void
+get_count_selectors(u32 mask, u64 *selectors)
+{
+    for(u32 count = 0;
+        count <= LIFE_MAX_NEIGHBOR_COUNT;
+        count += 1)
+    {
+        selectors[count] = 0ULL - (u64)((mask >> count) & 1);
+    }
+}
+
+// NOTE(ian): Bit set for every cell whose count s3s2s1s0 has its selector
+// set. The low two bits pick a count within each group of four, and the high
+// two pick the group.
+inline u64
+match_neighbor_count(u64 s0, u64 s1, u64 s2, u64 s3, u64 *selectors)
+{
+    u64 low[4];
+    low[0] = ~s1 & ~s0;
+    low[1] = ~s1 & s0;
+    low[2] = s1 & ~s0;
+    low[3] = s1 & s0;
+
+    u64 group0 = ((selectors[0] & low[0]) | (selectors[1] & low[1]) |
+                  (selectors[2] & low[2]) | (selectors[3] & low[3]));
+    u64 group1 = ((selectors[4] & low[0]) | (selectors[5] & low[1]) |
+                  (selectors[6] & low[2]) | (selectors[7] & low[3]));
+    u64 group2 = selectors[8] & low[0];
+
+    u64 result = ((~s3 & ~s2 & group0) |
+                  (~s3 & s2 & group1) |
+                  (s3 & ~s2 & group2));
+    return(result);
+}
+
+#define LIFE_RULE_H
+#endif
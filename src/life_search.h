@@ -0,0 +1,353 @@
+#ifndef LIFE_SEARCH_H
+
+// NOTE(ian): Finding every occurrence of a small pattern on the board, in
+// any of its eight orientations.
+//
+// A pattern is a rectangle of cells that must be alive, must be dead, or
+// don't matter. We test 64 placements at once: for the placements whose top
+// left corners are the 64 cells of one board word, the cell the pattern puts
+// at offset (i, j) is, for all 64 of them, the 64 board cells starting j
+// columns into that word on row i below. So each cell the pattern cares
+// about is one shifted load and an XOR against all-ones or all-zeros, ORed
+// into a mismatch word; whatever placements are still zero at the end match.
+// Live cells are checked first, since on most boards they rule out the most
+// placements, and we stop as soon as every placement has failed.
+//
+// Placements have to fit on the board. To find an object only where it
+// stands alone (a glider, not a glider-shaped corner of something bigger),
+// give it a border of dead cells.
+
+#define LIFE_SEARCH_MAX_SIZE 64
+
+struct life_search_cell
+{
+    u8 row;
+    u8 column;
+    u8 alive;
+};
+
+struct life_search_orientation
+{
+    life_transform transform; // NOTE(ian): what was done to the pattern as given
+    u32 rows;
+    u32 columns;
+    u32 cell_count;
+    life_search_cell *cells; // NOTE(ian): the cells we care about, live ones first
+};
+
+struct life_search_pattern
+{
+    u32 orientation_count; // NOTE(ian): symmetric patterns have fewer than eight
+    life_search_orientation orientations[Life_Transform_Count];
+};
+
+struct life_pattern_match
+{
+    u32 row;    // NOTE(ian): top left corner of the oriented pattern
+    u32 column;
+    life_transform transform;
+};
+
+// NOTE(ian): Plain text, rows separated by '/' or newlines: 'o', '*' or 'O'
+// alive, '.' or 'b' dead, '?' don't care. Short rows are padded with don't
+// care. Returns false for anything else, or a pattern that's too big or
+// cares about nothing. alive and care are pushed on arena.
+internal bool32
+parse_search_pattern(char *text, memory_arena *arena, life_grid *alive, life_grid *care)
+{
+    u32 rows = 0;
+    u32 columns = 0;
+    u32 row_length = 0;
+    for(char *at = text;
+        ;
+        at += 1)
+    {
+        if(*at == '/' || *at == '\n' || *at == 0)
+        {
+            if(row_length || *at != 0)
+            {
+                rows += 1;
+            }
+            columns = (row_length > columns) ? row_length : columns;
+            row_length = 0;
+            if(*at == 0)
+            {
+                break;
+            }
+        }
+        else if(*at != '\r')
+        {
+            row_length += 1;
+        }
+    }
+    if(rows == 0 || rows > LIFE_SEARCH_MAX_SIZE || columns == 0 || columns > LIFE_SEARCH_MAX_SIZE)
+    {
+        return(false);
+    }
+
+    push_grid(alive, arena, rows, columns);
+    push_grid(care, arena, rows, columns);
+    clear_grid_rows(alive, 0, rows);
+    clear_grid_rows(care, 0, rows);
+
+    bool32 cares = false;
+    u32 row = 0;
+    u32 column = 0;
+    for(char *at = text;
+        *at;
+        at += 1)
+    {
+        char c = *at;
+        if(c == '/' || c == '\n')
+        {
+            row += 1;
+            column = 0;
+        }
+        else if(c == 'o' || c == 'O' || c == '*')
+        {
+            set_cell(alive, row, column, true);
+            set_cell(care, row, column, true);
+            cares = true;
+            column += 1;
+        }
+        else if(c == '.' || c == 'b')
+        {
+            set_cell(care, row, column, true);
+            cares = true;
+            column += 1;
+        }
+        else if(c == '?')
+        {
+            column += 1;
+        }
+        else if(c != '\r')
+        {
+            return(false);
+        }
+    }
+    return(cares);
+}
+
+internal bool32
+grids_are_equal(life_grid *a, life_grid *b)
+{
+    bool32 result = (a->rows == b->rows && a->columns == b->columns &&
+                     memcmp(a->words, b->words, (u64)a->rows*a->words_per_row*sizeof(u64)) == 0);
+    return(result);
+}
+
+// NOTE(ian): care can be null, meaning every cell matters. Orientations that
+// come out the same as an earlier one are left out, so a block is searched
+// once and a glider eight times. Everything is pushed on arena.
+internal void
+compile_search_pattern(life_search_pattern *pattern, life_grid *alive, life_grid *care,
+                       memory_arena *arena)
+{
+    Assert(alive->rows <= LIFE_SEARCH_MAX_SIZE && alive->columns <= LIFE_SEARCH_MAX_SIZE);
+
+    life_grid all_care;
+    if(!care)
+    {
+        push_grid(&all_care, arena, alive->rows, alive->columns);
+        clear_grid_rows(&all_care, 0, alive->rows);
+        fill_grid_rect(&all_care, 0, 0, alive->rows, alive->columns, true);
+        care = &all_care;
+    }
+
+    life_grid oriented_alive[Life_Transform_Count];
+    life_grid oriented_care[Life_Transform_Count];
+    pattern->orientation_count = 0;
+    for(u32 transform = 0;
+        transform < Life_Transform_Count;
+        transform += 1)
+    {
+        u32 index = pattern->orientation_count;
+        oriented_alive[index] = push_transformed_grid(arena, alive, (life_transform)transform);
+        oriented_care[index] = push_transformed_grid(arena, care, (life_transform)transform);
+
+        bool32 repeat = false;
+        for(u32 other = 0;
+            other < index;
+            other += 1)
+        {
+            if(grids_are_equal(&oriented_alive[index], &oriented_alive[other]) &&
+               grids_are_equal(&oriented_care[index], &oriented_care[other]))
+            {
+                repeat = true;
+                break;
+            }
+        }
+        if(repeat)
+        {
+            continue;
+        }
+
+        life_grid *oriented = &oriented_care[index];
+        life_search_orientation *orientation = pattern->orientations + index;
+        orientation->transform = (life_transform)transform;
+        orientation->rows = oriented->rows;
+        orientation->columns = oriented->columns;
+        orientation->cell_count = 0;
+        orientation->cells = Push_Array(arena, (u64)oriented->rows*oriented->columns, life_search_cell);
+        for(u32 pass = 0;
+            pass < 2;
+            pass += 1)
+        {
+            bool32 want_alive = (pass == 0);
+            for(u32 row = 0;
+                row < oriented->rows;
+                row += 1)
+            {
+                for(u32 column = 0;
+                    column < oriented->columns;
+                    column += 1)
+                {
+                    if(get_cell(oriented, row, column) &&
+                       get_cell(&oriented_alive[index], row, column) == want_alive)
+                    {
+                        life_search_cell *cell = orientation->cells + orientation->cell_count++;
+                        cell->row = (u8)row;
+                        cell->column = (u8)column;
+                        cell->alive = (u8)want_alive;
+                    }
+                }
+            }
+        }
+        pattern->orientation_count += 1;
+    }
+}
+
+struct life_search_band
+{
+    life_pattern_match *matches;
+    u64 match_count; // NOTE(ian): can be more than max_matches; only that many are kept
+};
+
+struct life_search
+{
+    life_board *board;
+    life_search_pattern *pattern;
+    u64 max_matches;
+    life_search_band *bands;
+};
+
+// NOTE(ian): Matches with their top left corner in rows [first_row, end_row),
+// in order of row, then orientation, then column.
+internal void
+search_rows(life_grid *grid, life_search_pattern *pattern, u32 first_row, u32 end_row,
+            life_search_band *band, u64 max_matches)
+{
+    u32 word_count = (grid->columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    for(u32 row = first_row;
+        row < end_row;
+        row += 1)
+    {
+        for(u32 orientation_index = 0;
+            orientation_index < pattern->orientation_count;
+            orientation_index += 1)
+        {
+            life_search_orientation *orientation = pattern->orientations + orientation_index;
+            if(row + orientation->rows > grid->rows || orientation->columns > grid->columns)
+            {
+                continue;
+            }
+
+            // NOTE(ian): Placements starting past this column would hang off
+            // the right edge.
+            u32 end_column = grid->columns - orientation->columns + 1;
+            u32 end_word = (end_column + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+            for(u32 word_index = 0;
+                word_index < end_word;
+                word_index += 1)
+            {
+                u64 mismatch = ~get_column_mask(word_index, 0, end_column);
+                for(u32 cell_index = 0;
+                    cell_index < orientation->cell_count && mismatch != ~0ULL;
+                    cell_index += 1)
+                {
+                    life_search_cell *cell = orientation->cells + cell_index;
+                    u64 bits = get_row_bits(get_grid_row(grid, row + cell->row), word_count,
+                                            (s64)word_index*LIFE_WORD_BITS + cell->column);
+                    mismatch |= bits ^ (cell->alive ? ~0ULL : 0);
+                }
+
+                u64 found = ~mismatch;
+                while(found)
+                {
+                    u32 bit = find_lowest_set_bit(found);
+                    found &= found - 1;
+                    if(band->match_count < max_matches)
+                    {
+                        life_pattern_match *match = band->matches + band->match_count;
+                        match->row = row;
+                        match->column = word_index*LIFE_WORD_BITS + bit;
+                        match->transform = orientation->transform;
+                    }
+                    band->match_count += 1;
+                }
+            }
+        }
+    }
+}
+
+internal
+PLATFORM_WORK_CALLBACK(search_band_work)
+{
+    life_search *search = (life_search *)data;
+    life_board *board = search->board;
+    if(worker_index < board->band_count)
+    {
+        life_band *band = board->bands + worker_index;
+        search_rows(&board->grid, search->pattern, band->first_row, band->end_row,
+                    search->bands + worker_index, search->max_matches);
+    }
+}
+
+// NOTE(ian): Searches the board's current generation, a band per worker, and
+// stores up to max_matches matches in order of row. Returns how many there
+// were in all, which can be more. Each worker collects into its own buffer
+// of max_matches on scratch_arena (only the pages it writes get touched), and
+// those are gone again when this returns.
+internal u64
+find_pattern(life_board *board, life_search_pattern *pattern, life_pattern_match *matches,
+             u64 max_matches, memory_arena *scratch_arena)
+{
+    temporary_memory scratch_memory = begin_temporary_memory(scratch_arena);
+
+    life_search search;
+    search.board = board;
+    search.pattern = pattern;
+    search.max_matches = max_matches;
+    search.bands = Push_Array(scratch_arena, board->band_count, life_search_band);
+    for(u32 band_index = 0;
+        band_index < board->band_count;
+        band_index += 1)
+    {
+        search.bands[band_index].matches = Push_Array(scratch_arena, max_matches, life_pattern_match,
+                                                      LIFE_GRID_ALIGNMENT);
+        search.bands[band_index].match_count = 0;
+    }
+
+    global_platform.run_on_workers(search_band_work, &search);
+
+    u64 result = 0;
+    for(u32 band_index = 0;
+        band_index < board->band_count;
+        band_index += 1)
+    {
+        life_search_band *band = search.bands + band_index;
+        u64 kept = (band->match_count < max_matches) ? band->match_count : max_matches;
+        if(result < max_matches)
+        {
+            u64 room = max_matches - result;
+            memcpy(matches + result, band->matches, ((kept < room) ? kept : room)*sizeof(life_pattern_match));
+        }
+        result += band->match_count;
+    }
+
+    end_temporary_memory(scratch_memory);
+    return(result);
+}
+
+#define LIFE_SEARCH_H
+#endif
@@ -0,0 +1,355 @@
+// NOTE(ian): Headless video capture. Each frame is converted straight out of
+// the game_graphics_buffer into a free queue slot, already in the output
+// format, and a writer thread drains the queue with plain write()s. That
+// works on pipes as well as files, so
+//     linux_life -v - | ffmpeg -i - life.mp4
+// needs no display server and no temporary files.
+//
+// Two formats, picked by the file name:
+//     *.y4m, -  YUV4MPEG2, 4:4:4 (C444). Cells are one-colour blocks with
+//               one-pixel borders, and 4:2:0 would smear them.
+//     otherwise a stream of binary PPM (P6) images, for
+//               ffmpeg -f image2pipe -c:v ppm -i ...
+//
+// Unlike snapshot recording we never drop a frame; if the writer falls
+// behind, the caller waits for a slot.
+
+#include <signal.h>
+
+#define LINUX_CAPTURE_SLOT_COUNT 4
+#define LINUX_CAPTURE_FRAMES_PER_SECOND 30
+
+enum linux_capture_format
+{
+    Linux_Capture_PPM,
+    Linux_Capture_Y4M,
+};
+
+struct linux_capture
+{
+    int file;
+    linux_capture_format format;
+    int width;
+    int height;
+    u64 frame_size; // NOTE(ian): bytes per frame, including its header
+
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    pthread_t writer_thread;
+    bool32 stopping;
+    bool32 failed;
+
+    // NOTE(ian): Slots are used in order, so the queue is just two counters:
+    // frame queue_read is the next to write, queue_write the next to fill.
+    u8 *slots[LINUX_CAPTURE_SLOT_COUNT];
+    u32 queue_read;
+    u32 queue_write;
+
+    u64 frame_count;
+    u64 stall_count;
+};
+
+internal bool32
+linux_write_all(int file, u8 *memory, u64 size)
+{
+    while(size)
+    {
+        ssize_t written = write(file, memory, size);
+        if(written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(written <= 0)
+        {
+            return(false);
+        }
+        memory += written;
+        size -= (u64)written;
+    }
+    return(true);
+}
+
+// NOTE(ian): BT.601 studio range, in 8.8 fixed point.
+inline u8
+linux_get_luma(u32 red, u32 green, u32 blue)
+{
+    u8 result = (u8)(((66*red + 129*green + 25*blue + 128) >> 8) + 16);
+    return(result);
+}
+
+inline u8
+linux_get_blue_chroma(u32 red, u32 green, u32 blue)
+{
+    u8 result = (u8)(((s32)(-38*(s32)red - 74*(s32)green + 112*(s32)blue + 128) >> 8) + 128);
+    return(result);
+}
+
+inline u8
+linux_get_red_chroma(u32 red, u32 green, u32 blue)
+{
+    u8 result = (u8)(((s32)(112*(s32)red - 94*(s32)green - 18*(s32)blue + 128) >> 8) + 128);
+    return(result);
+}
+
+// NOTE(ian): Returns the number of bytes written to out.
+internal u64
+linux_convert_frame(linux_capture *capture, game_graphics_buffer *buffer, u8 *out)
+{
+    u8 *at = out;
+    if(capture->format == Linux_Capture_Y4M)
+    {
+        memcpy(at, "FRAME\n", 6);
+        at += 6;
+
+        u64 plane_size = (u64)buffer->width*buffer->height;
+        u8 *luma = at;
+        u8 *blue_chroma = luma + plane_size;
+        u8 *red_chroma = blue_chroma + plane_size;
+
+        u8 *row = (u8 *)buffer->memory;
+        for(int y = 0;
+            y < buffer->height;
+            y += 1)
+        {
+            u32 *pixel = (u32 *)row;
+            for(int x = 0;
+                x < buffer->width;
+                x += 1)
+            {
+                u32 red   = (*pixel >> 16) & 0xFF;
+                u32 green = (*pixel >> 8) & 0xFF;
+                u32 blue  = *pixel & 0xFF;
+                pixel += 1;
+
+                *luma++ = linux_get_luma(red, green, blue);
+                *blue_chroma++ = linux_get_blue_chroma(red, green, blue);
+                *red_chroma++ = linux_get_red_chroma(red, green, blue);
+            }
+            row += buffer->bytes_per_row;
+        }
+        at += 3*plane_size;
+    }
+    else
+    {
+        at += sprintf((char *)at, "P6\n%d %d\n255\n", buffer->width, buffer->height);
+
+        u8 *row = (u8 *)buffer->memory;
+        for(int y = 0;
+            y < buffer->height;
+            y += 1)
+        {
+            u32 *pixel = (u32 *)row;
+            for(int x = 0;
+                x < buffer->width;
+                x += 1)
+            {
+                *at++ = (u8)(*pixel >> 16);
+                *at++ = (u8)(*pixel >> 8);
+                *at++ = (u8)*pixel;
+                pixel += 1;
+            }
+            row += buffer->bytes_per_row;
+        }
+    }
+
+    u64 result = (u64)(at - out);
+    return(result);
+}
+
+internal void *
+linux_capture_thread_proc(void *parameter)
+{
+    linux_capture *capture = (linux_capture *)parameter;
+    for(;;)
+    {
+        pthread_mutex_lock(&capture->mutex);
+        while(capture->queue_read == capture->queue_write && !capture->stopping)
+        {
+            pthread_cond_wait(&capture->condition, &capture->mutex);
+        }
+        if(capture->queue_read == capture->queue_write)
+        {
+            pthread_mutex_unlock(&capture->mutex);
+            break;
+        }
+        u8 *slot = capture->slots[capture->queue_read % LINUX_CAPTURE_SLOT_COUNT];
+        pthread_mutex_unlock(&capture->mutex);
+
+        // NOTE(ian): Once the reader has gone away (ffmpeg quit, say) keep
+        // draining the queue so the simulation doesn't hang on us.
+        if(!capture->failed &&
+           !linux_write_all(capture->file, slot, capture->frame_size))
+        {
+            __atomic_store_n(&capture->failed, true, __ATOMIC_RELEASE);
+        }
+
+        pthread_mutex_lock(&capture->mutex);
+        capture->queue_read += 1;
+        pthread_cond_broadcast(&capture->condition);
+        pthread_mutex_unlock(&capture->mutex);
+    }
+    return(0);
+}
+
+internal void
+linux_free_capture_slots(linux_capture *capture)
+{
+    for(u32 slot_index = 0;
+        slot_index < LINUX_CAPTURE_SLOT_COUNT;
+        slot_index += 1)
+    {
+        free(capture->slots[slot_index]);
+        capture->slots[slot_index] = 0;
+    }
+}
+
+// NOTE(ian): False once a write has failed, when there's no point drawing
+// or converting any more frames.
+inline bool32
+linux_is_capturing(linux_capture *capture)
+{
+    bool32 result = (capture && !__atomic_load_n(&capture->failed, __ATOMIC_ACQUIRE));
+    return(result);
+}
+
+// NOTE(ian): path "-" means standard output.
+internal bool32
+linux_start_capture(linux_capture *capture, char *path, int width, int height)
+{
+    capture->format = Linux_Capture_PPM;
+    u64 path_length = strlen(path);
+    if(path_length >= 4 && strcmp(path + path_length - 4, ".y4m") == 0)
+    {
+        capture->format = Linux_Capture_Y4M;
+    }
+
+    if(strcmp(path, "-") == 0)
+    {
+        // NOTE(ian): The video gets the real stdout; everything we'd normally
+        // print there goes to stderr instead so it can't corrupt the stream.
+        fflush(stdout);
+        capture->file = dup(STDOUT_FILENO);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        capture->format = Linux_Capture_Y4M;
+    }
+    else
+    {
+        capture->file = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+        if(capture->file < 0)
+        {
+            fprintf(stderr, "linux_life: could not create %s\n", path);
+            return(false);
+        }
+    }
+
+    // NOTE(ian): A reader that quits early should fail our writes, not kill us.
+    signal(SIGPIPE, SIG_IGN);
+
+    capture->width = width;
+    capture->height = height;
+    if(capture->format == Linux_Capture_Y4M)
+    {
+        capture->frame_size = 6 + 3*(u64)width*height;
+
+        char header[128];
+        int header_size = snprintf(header, sizeof(header),
+                                   "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n",
+                                   width, height, LINUX_CAPTURE_FRAMES_PER_SECOND);
+        if(!linux_write_all(capture->file, (u8 *)header, (u64)header_size))
+        {
+            fprintf(stderr, "linux_life: could not write to %s\n", path);
+            close(capture->file);
+            return(false);
+        }
+    }
+    else
+    {
+        char header[64];
+        int header_size = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+        capture->frame_size = (u64)header_size + 3*(u64)width*height;
+    }
+
+    bool32 allocated = true;
+    for(u32 slot_index = 0;
+        slot_index < LINUX_CAPTURE_SLOT_COUNT;
+        slot_index += 1)
+    {
+        capture->slots[slot_index] = (u8 *)malloc(capture->frame_size);
+        if(!capture->slots[slot_index])
+        {
+            allocated = false;
+        }
+    }
+    if(!allocated)
+    {
+        fprintf(stderr, "linux_life: not enough memory to capture %dx%d frames\n", width, height);
+        linux_free_capture_slots(capture);
+        close(capture->file);
+        return(false);
+    }
+
+    pthread_mutex_init(&capture->mutex, 0);
+    pthread_cond_init(&capture->condition, 0);
+    capture->stopping = false;
+    capture->failed = false;
+    capture->queue_read = 0;
+    capture->queue_write = 0;
+    capture->frame_count = 0;
+    capture->stall_count = 0;
+    pthread_create(&capture->writer_thread, 0, linux_capture_thread_proc, capture);
+
+    return(true);
+}
+
+internal void
+linux_capture_frame(linux_capture *capture, game_graphics_buffer *buffer)
+{
+    Assert(buffer->width == capture->width && buffer->height == capture->height);
+    if(!linux_is_capturing(capture))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&capture->mutex);
+    if(capture->queue_write - capture->queue_read == LINUX_CAPTURE_SLOT_COUNT)
+    {
+        capture->stall_count += 1;
+        while(capture->queue_write - capture->queue_read == LINUX_CAPTURE_SLOT_COUNT)
+        {
+            pthread_cond_wait(&capture->condition, &capture->mutex);
+        }
+    }
+    u8 *slot = capture->slots[capture->queue_write % LINUX_CAPTURE_SLOT_COUNT];
+    pthread_mutex_unlock(&capture->mutex);
+
+    u64 size = linux_convert_frame(capture, buffer, slot);
+    Assert(size == capture->frame_size);
+
+    pthread_mutex_lock(&capture->mutex);
+    capture->queue_write += 1;
+    pthread_cond_broadcast(&capture->condition);
+    pthread_mutex_unlock(&capture->mutex);
+
+    capture->frame_count += 1;
+}
+
+internal bool32
+linux_stop_capture(linux_capture *capture)
+{
+    pthread_mutex_lock(&capture->mutex);
+    capture->stopping = true;
+    pthread_cond_broadcast(&capture->condition);
+    pthread_mutex_unlock(&capture->mutex);
+    pthread_join(capture->writer_thread, 0);
+
+    close(capture->file);
+    linux_free_capture_slots(capture);
+
+    fprintf(stderr, "captured %llu frames (%llu waits on the writer)%s\n",
+            (unsigned long long)capture->frame_count,
+            (unsigned long long)capture->stall_count,
+            capture->failed ? ", write failed" : "");
+
+    bool32 result = !capture->failed;
+    return(result);
+}
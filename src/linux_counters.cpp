@@ -0,0 +1,205 @@
+// NOTE(ian): Hardware performance counters around the phases of a -s run, so
+// we can tell whether a kernel is waiting on memory or on arithmetic, and pick
+// kernels per host type from numbers instead of guesses.
+//
+// Each event is its own perf_event_open counter on this process, with inherit
+// set, so it also counts every thread started after it's opened: open them
+// before the worker pool and the workers' share lands in our totals. Phases
+// run one at a time (the main thread waits while the workers step), so the
+// change in the totals across a phase is that phase's cost. Threads that run
+// alongside, like the capture writer, have to start before the counters do or
+// they'd be billed to whichever phase they overlap.
+//
+// Kernel events are excluded, which is what perf_event_paranoid 2 (the usual
+// default) allows. Events the CPU or VM doesn't have are left out of the
+// report. When there are more events than hardware counters the kernel takes
+// turns, and we scale each count up by how long it actually ran.
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+enum linux_counter_event
+{
+    Linux_Counter_Task_Clock,
+    Linux_Counter_Cycles,
+    Linux_Counter_Instructions,
+    Linux_Counter_L1D_Misses,
+    Linux_Counter_LLC_Misses,
+    Linux_Counter_Branch_Misses,
+
+    Linux_Counter_Count,
+};
+
+struct linux_counter_config
+{
+    const char *name;
+    u32 type;
+    u64 config;
+};
+
+global_variable linux_counter_config global_counter_configs[Linux_Counter_Count] =
+{
+    {"cpu ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"L1D misses", PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {"LLC misses", PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {"branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+struct linux_counter_values
+{
+    f64 values[Linux_Counter_Count];
+};
+
+struct linux_counter_phase
+{
+    linux_counter_values total;
+    linux_counter_values start;
+    u64 run_count;
+};
+
+enum linux_phase
+{
+    Linux_Phase_Step,
+    Linux_Phase_Render,
+
+    Linux_Phase_Count,
+};
+
+struct linux_counters
+{
+    int files[Linux_Counter_Count]; // NOTE(ian): -1 for events we couldn't open
+    linux_counter_phase phases[Linux_Phase_Count];
+};
+
+// NOTE(ian): Returns false only if none of the events could be opened.
+internal bool32
+linux_open_counters(linux_counters *counters)
+{
+    *counters = {};
+
+    bool32 result = false;
+    for(u32 event = 0;
+        event < Linux_Counter_Count;
+        event += 1)
+    {
+        linux_counter_config *config = global_counter_configs + event;
+
+        perf_event_attr attributes = {};
+        attributes.size = sizeof(attributes);
+        attributes.type = config->type;
+        attributes.config = config->config;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED|PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.inherit = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        counters->files[event] = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+        if(counters->files[event] >= 0)
+        {
+            result = true;
+        }
+        else
+        {
+            fprintf(stderr, "linux_life: no %s counter: %s\n", config->name, strerror(errno));
+        }
+    }
+    if(!result)
+    {
+        fprintf(stderr, "linux_life: no performance counters; "
+                "see /proc/sys/kernel/perf_event_paranoid\n");
+    }
+    return(result);
+}
+
+internal void
+linux_read_counters(linux_counters *counters, linux_counter_values *values)
+{
+    for(u32 event = 0;
+        event < Linux_Counter_Count;
+        event += 1)
+    {
+        values->values[event] = 0.0;
+
+        // NOTE(ian): value, time enabled, time running
+        u64 reading[3];
+        if(counters->files[event] >= 0 &&
+           read(counters->files[event], reading, sizeof(reading)) == sizeof(reading) &&
+           reading[2])
+        {
+            values->values[event] = (f64)reading[0]*((f64)reading[1] / (f64)reading[2]);
+        }
+    }
+}
+
+inline void
+linux_begin_phase(linux_counters *counters, linux_phase phase)
+{
+    if(counters)
+    {
+        linux_read_counters(counters, &counters->phases[phase].start);
+    }
+}
+
+inline void
+linux_end_phase(linux_counters *counters, linux_phase phase)
+{
+    if(counters)
+    {
+        linux_counter_phase *counter_phase = counters->phases + phase;
+        linux_counter_values end;
+        linux_read_counters(counters, &end);
+        for(u32 event = 0;
+            event < Linux_Counter_Count;
+            event += 1)
+        {
+            counter_phase->total.values[event] += end.values[event] - counter_phase->start.values[event];
+        }
+        counter_phase->run_count += 1;
+    }
+}
+
+// NOTE(ian): Prints each event for the phase in all, per unit (a generation,
+// a frame) and per item (a cell, a pixel), plus instructions per cycle. CPU
+// time is summed over every thread, so it's more than the wall clock when
+// the workers are busy.
+internal void
+linux_print_phase_counters(linux_counters *counters, linux_phase phase, const char *name,
+                           f64 unit_count, const char *unit_name,
+                           f64 item_count, const char *item_name)
+{
+    linux_counter_phase *counter_phase = counters->phases + phase;
+    if(!counter_phase->run_count || unit_count <= 0.0 || item_count <= 0.0)
+    {
+        return;
+    }
+
+    printf("%s counters: %.0f %ss of %.0f %ss\n", name, unit_count, unit_name,
+           item_count / unit_count, item_name);
+    f64 *values = counter_phase->total.values;
+    for(u32 event = 0;
+        event < Linux_Counter_Count;
+        event += 1)
+    {
+        if(counters->files[event] < 0)
+        {
+            continue;
+        }
+
+        f64 value = values[event];
+        printf("  %-14s %16.0f %14.1f/%s %12.4f/%s\n", global_counter_configs[event].name,
+               value, value / unit_count, unit_name, value / item_count, item_name);
+    }
+    if(counters->files[Linux_Counter_Cycles] >= 0 &&
+       counters->files[Linux_Counter_Instructions] >= 0 &&
+       values[Linux_Counter_Cycles] > 0.0)
+    {
+        printf("  %-14s %16.2f\n", "IPC",
+               values[Linux_Counter_Instructions] / values[Linux_Counter_Cycles]);
+    }
+}
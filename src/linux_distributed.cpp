@@ -0,0 +1,610 @@
+// NOTE(ian): Distributed stepping. The board is cut into horizontal bands,
+// one per worker process, and each process keeps only its own band plus a
+// halo of its neighbours' rows above and below, as an ordinary life_board.
+// That board is stepped with the normal kernels; only the halo has to come
+// from somewhere else.
+//
+// Every k generations (-k) the processes swap halos. A cell's state after k
+// generations depends only on cells within k rows of it (k times the radius
+// for Larger than Life), so with halos that deep a process can run k
+// generations on its own and its band still comes out exact. The halo rows
+// themselves go wrong from the outside in, which doesn't matter since the
+// next exchange replaces them. Deeper halos mean fewer, bigger messages, for
+// some redundant work on the halo rows.
+//
+// Messages go through a linux_transport, which only has to move bytes in
+// order over a link between two neighbours:
+//     shm     a pair of single-producer single-consumer rings per link in
+//             shared memory, waiting on futexes when full or empty
+//     socket  a Unix-domain socketpair per link
+// Anything else that can do that (a real interconnect, say) slots in as
+// another transport.
+//
+// Exchanges go in two phases, pairing bands (0,1), (2,3), ... and then
+// (1,2), (3,4), ..., and within a pair the upper band sends first. Nobody
+// ever waits on a neighbour that is itself waiting to send, so messages can
+// be any size, whatever the ring or socket buffer holds.
+//
+// If any process fails or dies, its neighbours would otherwise wait on it
+// forever, so the parent closes every ring and kills the rest. Socket ends
+// are only held open by the two processes they join, so a dead neighbour
+// reads as end of file.
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <limits.h>
+
+#define LINUX_RING_BYTES Megabytes(1)
+#define LINUX_RING_WAIT_NANOSECONDS 100000000
+
+struct linux_ring
+{
+    // NOTE(ian): Bytes written and read so far, mod 2^32. Each side only ever
+    // writes its own counter, and they're on separate cache lines.
+    u32 write_count;
+    u32 closed; // NOTE(ian): set by the parent once any process has failed
+    u8 write_padding[56];
+    u32 read_count;
+    u8 read_padding[60];
+    u8 data[LINUX_RING_BYTES];
+};
+
+struct linux_link;
+
+#define LINUX_TRANSPORT_SEND(name) bool32 name(linux_link *link, u8 *data, u64 size)
+typedef LINUX_TRANSPORT_SEND(linux_transport_send);
+
+#define LINUX_TRANSPORT_RECEIVE(name) bool32 name(linux_link *link, u8 *data, u64 size)
+typedef LINUX_TRANSPORT_RECEIVE(linux_transport_receive);
+
+struct linux_transport
+{
+    const char *name;
+    linux_transport_send *send;
+    linux_transport_receive *receive;
+};
+
+// NOTE(ian): One end of the connection to a neighbour.
+struct linux_link
+{
+    linux_transport *transport;
+    int socket;
+    linux_ring *outgoing;
+    linux_ring *incoming;
+};
+
+internal void
+linux_futex_wait(u32 *address, u32 expected)
+{
+    syscall(SYS_futex, address, FUTEX_WAIT, expected, 0, 0, 0);
+}
+
+// NOTE(ian): Returns straight away if *address has moved on since the caller
+// looked, so a wake can't get lost. The wait is timed so a ring closed just
+// after we checked is still noticed; returns false once it is.
+internal bool32
+linux_ring_wait(linux_ring *ring, u32 *address, u32 expected)
+{
+    if(__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE))
+    {
+        return(false);
+    }
+    timespec timeout = {0, LINUX_RING_WAIT_NANOSECONDS};
+    syscall(SYS_futex, address, FUTEX_WAIT, expected, &timeout, 0, 0);
+    return(true);
+}
+
+internal void
+linux_futex_wake(u32 *address)
+{
+    syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, 0, 0, 0);
+}
+
+internal
+LINUX_TRANSPORT_SEND(linux_ring_send)
+{
+    linux_ring *ring = link->outgoing;
+    while(size)
+    {
+        u32 read_count = __atomic_load_n(&ring->read_count, __ATOMIC_ACQUIRE);
+        u32 write_count = ring->write_count;
+        u32 space = LINUX_RING_BYTES - (write_count - read_count);
+        if(space == 0)
+        {
+            if(!linux_ring_wait(ring, &ring->read_count, read_count))
+            {
+                return(false);
+            }
+            continue;
+        }
+
+        u32 chunk = (size < space) ? (u32)size : space;
+        u32 offset = write_count % LINUX_RING_BYTES;
+        u32 first_part = (chunk < LINUX_RING_BYTES - offset) ? chunk : (LINUX_RING_BYTES - offset);
+        memcpy(ring->data + offset, data, first_part);
+        memcpy(ring->data, data + first_part, chunk - first_part);
+
+        __atomic_store_n(&ring->write_count, write_count + chunk, __ATOMIC_RELEASE);
+        linux_futex_wake(&ring->write_count);
+        data += chunk;
+        size -= chunk;
+    }
+    return(true);
+}
+
+internal
+LINUX_TRANSPORT_RECEIVE(linux_ring_receive)
+{
+    linux_ring *ring = link->incoming;
+    while(size)
+    {
+        u32 write_count = __atomic_load_n(&ring->write_count, __ATOMIC_ACQUIRE);
+        u32 read_count = ring->read_count;
+        u32 available = write_count - read_count;
+        if(available == 0)
+        {
+            if(!linux_ring_wait(ring, &ring->write_count, write_count))
+            {
+                return(false);
+            }
+            continue;
+        }
+
+        u32 chunk = (size < available) ? (u32)size : available;
+        u32 offset = read_count % LINUX_RING_BYTES;
+        u32 first_part = (chunk < LINUX_RING_BYTES - offset) ? chunk : (LINUX_RING_BYTES - offset);
+        memcpy(data, ring->data + offset, first_part);
+        memcpy(data + first_part, ring->data, chunk - first_part);
+
+        __atomic_store_n(&ring->read_count, read_count + chunk, __ATOMIC_RELEASE);
+        linux_futex_wake(&ring->read_count);
+        data += chunk;
+        size -= chunk;
+    }
+    return(true);
+}
+
+internal
+LINUX_TRANSPORT_SEND(linux_socket_send)
+{
+    bool32 result = linux_write_all(link->socket, data, size);
+    return(result);
+}
+
+internal
+LINUX_TRANSPORT_RECEIVE(linux_socket_receive)
+{
+    while(size)
+    {
+        ssize_t received = read(link->socket, data, size);
+        if(received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(received <= 0)
+        {
+            return(false);
+        }
+        data += received;
+        size -= (u64)received;
+    }
+    return(true);
+}
+
+global_variable linux_transport global_ring_transport = {"shm", linux_ring_send, linux_ring_receive};
+global_variable linux_transport global_socket_transport = {"socket", linux_socket_send, linux_socket_receive};
+
+// NOTE(ian): One band of the board and its process.
+struct linux_node
+{
+    u32 index;
+    u32 first_row; // NOTE(ian): the rows this node owns, in board rows
+    u32 end_row;
+    u32 top_halo;  // NOTE(ian): halo rows held above and below them
+    u32 bottom_halo;
+
+    linux_link *above; // NOTE(ian): null for the top band
+    linux_link *below; // NOTE(ian): null for the bottom band
+};
+
+// NOTE(ian): Written by each process into shared memory for the parent.
+struct linux_node_result
+{
+    bool32 succeeded;
+    life_stats stats;
+    f32 seconds;          // NOTE(ian): stepping and exchanging, not setting up
+    f32 exchange_seconds;
+};
+
+// NOTE(ian): Rows are contiguous in each plane, so a run of them is one
+// message per plane: the live cells, then each age plane.
+internal bool32
+linux_send_rows(linux_link *link, life_board *board, u32 first_row, u32 row_count)
+{
+    bool32 result = true;
+    u64 size = (u64)row_count*board->grid.words_per_row*sizeof(u64);
+    for(u32 plane = 0;
+        result && plane <= board->age_plane_count;
+        plane += 1)
+    {
+        life_grid *grid = plane ? &board->age_planes[plane - 1] : &board->grid;
+        result = link->transport->send(link, (u8 *)get_grid_row(grid, first_row), size);
+    }
+    return(result);
+}
+
+internal bool32
+linux_receive_rows(linux_link *link, life_board *board, u32 first_row, u32 row_count)
+{
+    bool32 result = true;
+    u64 size = (u64)row_count*board->grid.words_per_row*sizeof(u64);
+    for(u32 plane = 0;
+        result && plane <= board->age_plane_count;
+        plane += 1)
+    {
+        life_grid *grid = plane ? &board->age_planes[plane - 1] : &board->grid;
+        result = link->transport->receive(link, (u8 *)get_grid_row(grid, first_row), size);
+    }
+    return(result);
+}
+
+// NOTE(ian): board's rows are the node's top halo, its own rows, and its
+// bottom halo. Each side gets as many of our own rows as its halo is deep.
+internal bool32
+linux_exchange_halos(linux_node *node, life_board *board)
+{
+    u32 owned_rows = node->end_row - node->first_row;
+    bool32 result = true;
+    for(u32 phase = 0;
+        phase < 2;
+        phase += 1)
+    {
+        if(result && node->below && (node->index % 2) == phase)
+        {
+            u32 halo = node->bottom_halo;
+            result = (linux_send_rows(node->below, board, node->top_halo + owned_rows - halo, halo) &&
+                      linux_receive_rows(node->below, board, node->top_halo + owned_rows, halo));
+        }
+        if(result && node->above && ((node->index - 1) % 2) == phase)
+        {
+            u32 halo = node->top_halo;
+            result = (linux_receive_rows(node->above, board, 0, halo) &&
+                      linux_send_rows(node->above, board, halo, halo));
+        }
+    }
+    return(result);
+}
+
+internal
+PLATFORM_RUN_ON_WORKERS(linux_run_serially)
+{
+    callback(0, data);
+}
+
+internal void
+linux_run_node(linux_node *node, linux_node_result *result, int generation_count,
+               u32 columns, life_rule rule, f32 density, u32 block_generations)
+{
+    memory_arena arena;
+    memory_arena scratch_arena;
+    initialize_arena(&arena, Megabytes(64), Platform_Memory_Huge_Pages);
+    initialize_arena(&scratch_arena, Megabytes(64));
+
+    u32 owned_rows = node->end_row - node->first_row;
+    u32 local_rows = node->top_halo + owned_rows + node->bottom_halo;
+    life_board board;
+    initialize_board(&board, &arena, local_rows, columns, rule);
+
+    // NOTE(ian): Seeded by board row, so the soup is the one a single
+    // process would make. The halos come with the first exchange.
+    u32 level = get_density_level(density);
+    for(u32 row = 0;
+        row < owned_rows;
+        row += 1)
+    {
+        life_random random;
+        seed_row_random(&random, 1, node->first_row + row);
+        fill_row_random(get_grid_row(&board.grid, node->top_halo + row), 0, columns, level, &random);
+    }
+
+    result->succeeded = true;
+    result->exchange_seconds = 0;
+    timespec start = linux_get_wall_clock();
+    for(int generation = 0;
+        result->succeeded && generation < generation_count;
+        generation += block_generations)
+    {
+        u32 count = block_generations;
+        if(generation + (int)count > generation_count)
+        {
+            count = (u32)(generation_count - generation);
+        }
+
+        timespec exchange_start = linux_get_wall_clock();
+        result->succeeded = linux_exchange_halos(node, &board);
+        result->exchange_seconds += linux_get_seconds_elapsed(exchange_start, linux_get_wall_clock());
+
+        if(count > 1)
+        {
+            step_board_blocked(&board, count, &scratch_arena);
+        }
+        else
+        {
+            step_board(&board);
+        }
+    }
+    result->seconds = linux_get_seconds_elapsed(start, linux_get_wall_clock());
+
+    // NOTE(ian): board.stats covers the halos too, so count our own rows.
+    clear_stats(&result->stats);
+    u32 word_count = (columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    for(u32 row = 0;
+        row < owned_rows;
+        row += 1)
+    {
+        add_row_stats(&result->stats, node->first_row + row,
+                      get_grid_row(&board.grid, node->top_halo + row), 0, word_count, 0);
+    }
+}
+
+// NOTE(ian): Closes every socket end in uppers and lowers but keep_above and
+// keep_below (a node's own ends, or null to close them all).
+internal void
+linux_close_links(linux_link *uppers, linux_link *lowers, u32 link_count,
+                  linux_link *keep_above, linux_link *keep_below)
+{
+    for(u32 link_index = 0;
+        link_index < link_count;
+        link_index += 1)
+    {
+        linux_link *ends[2] = {uppers + link_index, lowers + link_index};
+        for(u32 end = 0;
+            end < Array_Count(ends);
+            end += 1)
+        {
+            linux_link *link = ends[end];
+            if(link->socket >= 0 && link != keep_above && link != keep_below)
+            {
+                close(link->socket);
+                link->socket = -1;
+            }
+        }
+    }
+}
+
+// NOTE(ian): Once anything has gone wrong: closes every ring, so nobody keeps
+// waiting on a process that's gone, and kills whichever are still running.
+// processes holds 0 for the ones already reaped or never started.
+internal void
+linux_stop_nodes(linux_ring *rings, u32 ring_count, pid_t *processes, u32 process_count)
+{
+    for(u32 ring_index = 0;
+        ring_index < ring_count;
+        ring_index += 1)
+    {
+        linux_ring *ring = rings + ring_index;
+        __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+        linux_futex_wake(&ring->write_count);
+        linux_futex_wake(&ring->read_count);
+    }
+    for(u32 node_index = 0;
+        node_index < process_count;
+        node_index += 1)
+    {
+        if(processes[node_index] > 0)
+        {
+            kill(processes[node_index], SIGKILL);
+        }
+    }
+}
+
+// NOTE(ian): Runs the board split across process_count processes, each
+// pinned to its own CPU where there are enough, and prints the result. This
+// has to happen before the worker threads start, since fork only copies the
+// thread that calls it.
+internal bool32
+linux_run_distributed(u32 process_count, linux_transport *transport, int generation_count,
+                      u32 rows, u32 columns, life_rule rule, f32 density, u32 block_generations)
+{
+    if(block_generations < 1)
+    {
+        block_generations = 1;
+    }
+    u32 reach = rule.radius ? rule.radius : 1;
+    u32 halo = block_generations*reach;
+    if(rows / process_count < halo)
+    {
+        fprintf(stderr, "linux_life: %u rows is too few for %u processes with %u-row halos\n",
+                rows, process_count, halo);
+        return(false);
+    }
+
+    global_platform.allocate_memory = linux_allocate_memory;
+    global_platform.commit_memory = linux_commit_memory;
+    global_platform.deallocate_memory = linux_deallocate_memory;
+    global_platform.worker_count = 1;
+    global_platform.run_on_workers = linux_run_serially;
+    linux_get_worker_topology(&global_worker_pool);
+
+    // NOTE(ian): Everything the processes share is set up before forking:
+    // the results, and link i, between nodes i and i + 1, as either two rings
+    // (down and up) or a socketpair.
+    u32 link_count = process_count - 1;
+    u32 ring_count = (transport == &global_ring_transport) ? 2*link_count : 0;
+    u64 shared_size = sizeof(linux_node_result)*process_count + (u64)ring_count*sizeof(linux_ring);
+    u8 *shared = (u8 *)mmap(0, shared_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if(shared == MAP_FAILED)
+    {
+        fprintf(stderr, "linux_life: could not map shared memory\n");
+        return(false);
+    }
+    linux_node_result *results = (linux_node_result *)shared;
+    linux_ring *rings = (linux_ring *)(shared + sizeof(linux_node_result)*process_count);
+
+    bool32 succeeded = true;
+    linux_link *uppers = (linux_link *)calloc(link_count + 1, sizeof(linux_link)); // NOTE(ian): node i's end of link i
+    linux_link *lowers = (linux_link *)calloc(link_count + 1, sizeof(linux_link)); // NOTE(ian): node i + 1's end
+    for(u32 link_index = 0;
+        link_index < link_count;
+        link_index += 1)
+    {
+        linux_link *upper = uppers + link_index;
+        linux_link *lower = lowers + link_index;
+        upper->transport = transport;
+        lower->transport = transport;
+        upper->socket = -1;
+        lower->socket = -1;
+        if(transport == &global_ring_transport)
+        {
+            upper->outgoing = rings + 2*link_index;
+            lower->incoming = rings + 2*link_index;
+            lower->outgoing = rings + 2*link_index + 1;
+            upper->incoming = rings + 2*link_index + 1;
+        }
+        else if(succeeded)
+        {
+            int sockets[2];
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0)
+            {
+                upper->socket = sockets[0];
+                lower->socket = sockets[1];
+            }
+            else
+            {
+                fprintf(stderr, "linux_life: could not create a socket pair: %s\n", strerror(errno));
+                succeeded = false;
+            }
+        }
+    }
+
+    pid_t *processes = (pid_t *)calloc(process_count, sizeof(pid_t));
+    u32 running_count = 0;
+    if(succeeded)
+    {
+        fflush(stdout);
+        for(u32 node_index = 0;
+            node_index < process_count;
+            node_index += 1)
+        {
+            linux_node node = {};
+            node.index = node_index;
+            node.first_row = (u32)((u64)rows*node_index / process_count);
+            node.end_row = (u32)((u64)rows*(node_index + 1) / process_count);
+            node.above = node_index ? (lowers + node_index - 1) : 0;
+            node.below = (node_index + 1 < process_count) ? (uppers + node_index) : 0;
+            node.top_halo = node.above ? halo : 0;
+            node.bottom_halo = node.below ? halo : 0;
+
+            pid_t process = fork();
+            if(process == 0)
+            {
+                linux_close_links(uppers, lowers, link_count, node.above, node.below);
+
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(global_worker_pool.worker_cpus[node_index % global_worker_pool.worker_count], &cpus);
+                sched_setaffinity(0, sizeof(cpus), &cpus);
+
+                linux_run_node(&node, results + node_index, generation_count, columns, rule,
+                               density, block_generations);
+                _exit(results[node_index].succeeded ? 0 : 1);
+            }
+            else if(process < 0)
+            {
+                fprintf(stderr, "linux_life: fork failed: %s\n", strerror(errno));
+                succeeded = false;
+                break;
+            }
+            processes[node_index] = process;
+            running_count += 1;
+        }
+    }
+
+    // NOTE(ian): Only the two processes on a link may hold its sockets, or a
+    // dead one's neighbour would never see end of file.
+    linux_close_links(uppers, lowers, link_count, 0, 0);
+    if(!succeeded)
+    {
+        linux_stop_nodes(rings, ring_count, processes, process_count);
+    }
+
+    // NOTE(ian): Reaped in whatever order they finish, so the first failure
+    // stops the rest straight away. Those are only reported as a group.
+    while(running_count)
+    {
+        int status;
+        pid_t process = waitpid(-1, &status, 0);
+        if(process < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for(u32 node_index = 0;
+            node_index < process_count;
+            node_index += 1)
+        {
+            if(processes[node_index] == process)
+            {
+                processes[node_index] = 0;
+                running_count -= 1;
+                if((!WIFEXITED(status) || WEXITSTATUS(status) != 0) && succeeded)
+                {
+                    fprintf(stderr, "linux_life: process %u failed; stopping the others\n", node_index);
+                    succeeded = false;
+                    linux_stop_nodes(rings, ring_count, processes, process_count);
+                }
+            }
+        }
+    }
+
+    if(succeeded)
+    {
+        // NOTE(ian): The processes hold each other up at every exchange, so
+        // the slowest one is how long the run took.
+        life_stats stats;
+        clear_stats(&stats);
+        f32 seconds = 0;
+        f32 exchange_seconds = 0;
+        for(u32 node_index = 0;
+            node_index < process_count;
+            node_index += 1)
+        {
+            linux_node_result *result = results + node_index;
+            merge_stats(&stats, &result->stats);
+            if(result->seconds > seconds)
+            {
+                seconds = result->seconds;
+                exchange_seconds = result->exchange_seconds;
+            }
+        }
+
+        f64 cells = (f64)rows*(f64)columns*(f64)generation_count;
+        printf("%ux%u board, %d generations (%u per exchange) on %u processes over %s "
+               "in %.03fs, %.03f Gcells/s, %.01f%% exchanging\n",
+               rows, columns, generation_count, block_generations, process_count, transport->name,
+               seconds, cells / (seconds * 1e9), seconds ? 100.0f*exchange_seconds / seconds : 0.0f);
+        if(stats.population)
+        {
+            printf("population %llu, rows %u to %u, columns %u to %u\n",
+                   (unsigned long long)stats.population,
+                   stats.min_row, stats.max_row, stats.min_column, stats.max_column);
+        }
+        else
+        {
+            printf("population 0\n");
+        }
+    }
+
+    free(processes);
+    free(uppers);
+    free(lowers);
+    munmap(shared, shared_size);
+    return(succeeded);
+}
@@ -0,0 +1,998 @@
+#include "life.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// NOTE(ian): Headless Linux platform layer. There's no window here; we run the
+// same game_update_and_render the Win32 build does into an offscreen buffer,
+// which is what we want on servers anyway.
+
+struct linux_memory_block
+{
+    platform_memory_block block;
+    void *mapping;
+    u64 mapping_size;
+};
+
+#define LINUX_HUGE_PAGE_SIZE Megabytes(2)
+#define LINUX_COMMIT_GRANULARITY Kilobytes(64)
+
+#define LINUX_MAX_WORKERS 256
+#define LINUX_MAX_NUMA_NODES 64
+
+struct linux_worker_pool
+{
+    // NOTE(ian): job_mutex is held for a whole linux_run_on_workers, so two
+    // threads stepping different boards take turns instead of clobbering
+    // each other's job; mutex guards the fields below.
+    pthread_mutex_t job_mutex;
+    pthread_mutex_t mutex;
+    pthread_cond_t start_condition;
+    pthread_cond_t done_condition;
+
+    u32 job_index;
+    u32 pending_count;
+    platform_work_callback *callback;
+    void *data;
+
+    u32 worker_count;
+    u32 node_count;
+    u32 worker_cpus[LINUX_MAX_WORKERS];
+    u32 worker_nodes[LINUX_MAX_WORKERS];
+    pthread_t worker_threads[LINUX_MAX_WORKERS];
+};
+
+global_variable bool32 global_running;
+global_variable u64 global_page_size;
+global_variable linux_worker_pool global_worker_pool;
+
+inline u64
+linux_align_up(u64 value, u64 alignment)
+{
+    u64 result = (value + alignment - 1) & ~(alignment - 1);
+    return(result);
+}
+
+inline timespec
+linux_get_wall_clock(void)
+{
+    timespec result;
+    clock_gettime(CLOCK_MONOTONIC, &result);
+    return(result);
+}
+
+inline f32
+linux_get_seconds_elapsed(timespec start, timespec end)
+{
+    f32 result = ((f32)(end.tv_sec - start.tv_sec) +
+                  (f32)(end.tv_nsec - start.tv_nsec) / 1000000000.0f);
+    return(result);
+}
+
+internal
+PLATFORM_ALLOCATE_MEMORY(linux_allocate_memory)
+{
+    u64 header_size = linux_align_up(sizeof(linux_memory_block), ARENA_ROW_ALIGNMENT);
+    linux_memory_block *result = 0;
+
+    if(flags & Platform_Memory_Huge_Pages)
+    {
+        // NOTE(ian): Explicit huge pages come out of the pool the admin set up
+        // in /proc/sys/vm/nr_hugepages, and they're committed immediately.
+        // Most boxes have an empty pool, so failing here is normal.
+        u64 mapping_size = linux_align_up(size + header_size, LINUX_HUGE_PAGE_SIZE);
+        void *mapping = mmap(0, mapping_size, PROT_READ|PROT_WRITE,
+                             MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if(mapping != MAP_FAILED)
+        {
+            result = (linux_memory_block *)mapping;
+            result->mapping = mapping;
+            result->mapping_size = mapping_size;
+            result->block.base = (u8 *)mapping + header_size;
+            result->block.size = mapping_size - header_size;
+            result->block.committed = result->block.size;
+        }
+    }
+
+    if(!result)
+    {
+        // NOTE(ian): Reserve with PROT_NONE and commit with mprotect as the
+        // arena grows. We over-reserve by a huge page so base can sit on a
+        // 2MB boundary, which is what transparent huge pages need to kick in.
+        u64 mapping_size = size + header_size + LINUX_HUGE_PAGE_SIZE;
+        void *mapping = mmap(0, mapping_size, PROT_NONE,
+                             MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+        if(mapping != MAP_FAILED)
+        {
+            u8 *base = (u8 *)linux_align_up((u64)mapping + header_size, LINUX_HUGE_PAGE_SIZE);
+            u8 *header_page = (u8 *)((u64)(base - header_size) & ~(global_page_size - 1));
+            if(mprotect(header_page, base - header_page, PROT_READ|PROT_WRITE) == 0)
+            {
+                if(flags & Platform_Memory_Huge_Pages)
+                {
+                    madvise(base, size, MADV_HUGEPAGE);
+                }
+
+                result = (linux_memory_block *)(base - header_size);
+                result->mapping = mapping;
+                result->mapping_size = mapping_size;
+                result->block.base = base;
+                result->block.size = size;
+                result->block.committed = 0;
+            }
+            else
+            {
+                munmap(mapping, mapping_size);
+            }
+        }
+    }
+
+    platform_memory_block *block = 0;
+    if(result)
+    {
+        block = &result->block;
+        block->flags = flags;
+        block->used = 0;
+        block->prev = 0;
+    }
+    return(block);
+}
+
+internal
+PLATFORM_COMMIT_MEMORY(linux_commit_memory)
+{
+    bool32 result = true;
+    if(size > block->committed)
+    {
+        u64 granularity = LINUX_COMMIT_GRANULARITY;
+        if(block->flags & Platform_Memory_Huge_Pages)
+        {
+            granularity = LINUX_HUGE_PAGE_SIZE;
+        }
+
+        u64 commit_end = linux_align_up(size, granularity);
+        if(commit_end > block->size)
+        {
+            commit_end = block->size;
+        }
+
+        // NOTE(ian): mprotect only flips the protection; the pages themselves
+        // aren't faulted in until someone touches them.
+        if(mprotect(block->base + block->committed, commit_end - block->committed,
+                    PROT_READ|PROT_WRITE) == 0)
+        {
+            block->committed = commit_end;
+        }
+        else
+        {
+            result = false;
+        }
+    }
+    return(result);
+}
+
+internal
+PLATFORM_DEALLOCATE_MEMORY(linux_deallocate_memory)
+{
+    if(block)
+    {
+        linux_memory_block *linux_block = (linux_memory_block *)block;
+        munmap(linux_block->mapping, linux_block->mapping_size);
+    }
+}
+
+// NOTE(ian): Parses a sysfs cpu list like "0-3,8,10-11" and appends every
+// cpu in it that we're actually allowed to run on.
+internal void
+linux_add_cpu_list(linux_worker_pool *pool, char *list, u32 node, cpu_set_t *allowed)
+{
+    char *at = list;
+    while(*at && *at != '\n')
+    {
+        u32 first = (u32)strtoul(at, &at, 10);
+        u32 last = first;
+        if(*at == '-')
+        {
+            at += 1;
+            last = (u32)strtoul(at, &at, 10);
+        }
+        for(u32 cpu = first;
+            cpu <= last && pool->worker_count < LINUX_MAX_WORKERS;
+            cpu += 1)
+        {
+            if(cpu < CPU_SETSIZE && CPU_ISSET(cpu, allowed))
+            {
+                pool->worker_cpus[pool->worker_count] = cpu;
+                pool->worker_nodes[pool->worker_count] = node;
+                pool->worker_count += 1;
+            }
+        }
+        if(*at == ',')
+        {
+            at += 1;
+        }
+    }
+}
+
+internal void
+linux_get_worker_topology(linux_worker_pool *pool)
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    // NOTE(ian): Workers are numbered node by node, so neighbouring bands of
+    // the grid end up on the same socket.
+    pool->worker_count = 0;
+    pool->node_count = 0;
+    for(u32 node = 0;
+        node < LINUX_MAX_NUMA_NODES;
+        node += 1)
+    {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+        FILE *file = fopen(path, "r");
+        if(file)
+        {
+            char list[4096];
+            if(fgets(list, sizeof(list), file))
+            {
+                u32 old_count = pool->worker_count;
+                linux_add_cpu_list(pool, list, node, &allowed);
+                if(pool->worker_count > old_count)
+                {
+                    pool->node_count += 1;
+                }
+            }
+            fclose(file);
+        }
+    }
+
+    if(pool->worker_count == 0)
+    {
+        // NOTE(ian): No NUMA information (containers often hide it), so treat
+        // the whole machine as one node.
+        pool->node_count = 1;
+        for(u32 cpu = 0;
+            cpu < CPU_SETSIZE && pool->worker_count < LINUX_MAX_WORKERS;
+            cpu += 1)
+        {
+            if(CPU_ISSET(cpu, &allowed))
+            {
+                pool->worker_cpus[pool->worker_count] = cpu;
+                pool->worker_nodes[pool->worker_count] = 0;
+                pool->worker_count += 1;
+            }
+        }
+    }
+
+    if(pool->worker_count == 0)
+    {
+        pool->worker_count = 1;
+        pool->worker_cpus[0] = 0;
+        pool->worker_nodes[0] = 0;
+    }
+}
+
+internal void *
+linux_worker_thread_proc(void *parameter)
+{
+    linux_worker_pool *pool = &global_worker_pool;
+    u32 worker_index = (u32)(u64)parameter;
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(pool->worker_cpus[worker_index], &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+    u32 seen_job_index = 0;
+    for(;;)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        while(pool->job_index == seen_job_index)
+        {
+            pthread_cond_wait(&pool->start_condition, &pool->mutex);
+        }
+        seen_job_index = pool->job_index;
+        platform_work_callback *callback = pool->callback;
+        void *data = pool->data;
+        pthread_mutex_unlock(&pool->mutex);
+
+        callback(worker_index, data);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->pending_count -= 1;
+        if(pool->pending_count == 0)
+        {
+            pthread_cond_signal(&pool->done_condition);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    return(0);
+}
+
+internal
+PLATFORM_RUN_ON_WORKERS(linux_run_on_workers)
+{
+    linux_worker_pool *pool = &global_worker_pool;
+
+    pthread_mutex_lock(&pool->job_mutex);
+    pthread_mutex_lock(&pool->mutex);
+    pool->callback = callback;
+    pool->data = data;
+    pool->pending_count = pool->worker_count;
+    pool->job_index += 1;
+    pthread_cond_broadcast(&pool->start_condition);
+    while(pool->pending_count)
+    {
+        pthread_cond_wait(&pool->done_condition, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_unlock(&pool->job_mutex);
+}
+
+internal void
+linux_start_workers(linux_worker_pool *pool)
+{
+    pthread_mutex_init(&pool->job_mutex, 0);
+    pthread_mutex_init(&pool->mutex, 0);
+    pthread_cond_init(&pool->start_condition, 0);
+    pthread_cond_init(&pool->done_condition, 0);
+    pool->job_index = 0;
+    pool->pending_count = 0;
+
+    linux_get_worker_topology(pool);
+    for(u32 worker_index = 0;
+        worker_index < pool->worker_count;
+        worker_index += 1)
+    {
+        pthread_create(&pool->worker_threads[worker_index], 0,
+                       linux_worker_thread_proc, (void *)(u64)worker_index);
+    }
+}
+
+internal void
+linux_print_arena_stats(const char *name, memory_arena *arena)
+{
+    arena_stats stats = get_arena_stats(arena);
+    printf("%s arena: %u blocks, used %llu, high water %llu, committed %llu, reserved %llu\n",
+           name, stats.block_count,
+           (unsigned long long)stats.used,
+           (unsigned long long)stats.high_water_mark,
+           (unsigned long long)stats.committed,
+           (unsigned long long)stats.reserved);
+}
+
+internal void
+linux_print_stats(u64 generation, life_stats *stats)
+{
+    if(stats->population)
+    {
+        printf("%llu\t%llu\t%llu\t%llu\t%u\t%u\t%u\t%u\n",
+               (unsigned long long)generation,
+               (unsigned long long)stats->population,
+               (unsigned long long)stats->births,
+               (unsigned long long)stats->deaths,
+               stats->min_row, stats->min_column, stats->max_row, stats->max_column);
+    }
+    else
+    {
+        printf("%llu\t0\t%llu\t%llu\t-\t-\t-\t-\n",
+               (unsigned long long)generation,
+               (unsigned long long)stats->births,
+               (unsigned long long)stats->deaths);
+    }
+}
+
+#include "linux_stream.cpp"
+#include "linux_record.cpp"
+#include "linux_capture.cpp"
+#include "linux_distributed.cpp"
+#include "linux_counters.cpp"
+#include "linux_pipeline.cpp"
+#include "gol.cpp"
+#include "game_of_life.h"
+#include "game_input_log.h"
+#include "linux_replay.cpp"
+
+// NOTE(ian): The permanent arena holds boards and anything else that lives
+// for the whole run. The transient arena is scratch space; use
+// begin_temporary_memory/end_temporary_memory around per-generation work.
+struct linux_memory
+{
+    memory_arena permanent_arena;
+    memory_arena transient_arena;
+};
+
+// NOTE(ian): index is null unless the board is bigger than the frame.
+internal void
+linux_capture_board(linux_capture *capture, game_graphics_buffer *buffer, life_board *board,
+                    life_population_index *index)
+{
+    color on_color = {0.0f, 0.0f, 0.0f};
+    color off_color = {1.0f, 1.0f, 1.0f};
+    if(index)
+    {
+        update_population_index(index);
+    }
+    draw_grid_overview(buffer, &board->grid, on_color, off_color, index);
+    linux_capture_frame(capture, buffer);
+}
+
+// NOTE(ian): Indexed by life_transform.
+global_variable const char *global_transform_names[Life_Transform_Count] =
+{
+    "identity", "flip_horizontal", "flip_vertical", "rotate_180",
+    "transpose", "rotate_90", "rotate_270", "anti_transpose",
+};
+
+#define LINUX_MAX_PRINTED_MATCHES (1 << 20)
+
+// NOTE(ian): Prints every match of the pattern on the board as it stands,
+// one "row column orientation" line each, tab separated.
+internal bool32
+linux_print_pattern_matches(life_board *board, char *pattern_text, memory_arena *arena)
+{
+    temporary_memory pattern_memory = begin_temporary_memory(arena);
+    life_grid alive;
+    life_grid care;
+    bool32 result = parse_search_pattern(pattern_text, arena, &alive, &care);
+    if(result)
+    {
+        life_search_pattern pattern;
+        compile_search_pattern(&pattern, &alive, &care, arena);
+
+        life_pattern_match *matches = Push_Array(arena, LINUX_MAX_PRINTED_MATCHES, life_pattern_match);
+        timespec start = linux_get_wall_clock();
+        u64 match_count = find_pattern(board, &pattern, matches, LINUX_MAX_PRINTED_MATCHES, arena);
+        timespec end = linux_get_wall_clock();
+
+        printf("%s: %llu matches (%u orientations) in %.03fs\n", pattern_text,
+               (unsigned long long)match_count, pattern.orientation_count,
+               linux_get_seconds_elapsed(start, end));
+        for(u64 match_index = 0;
+            match_index < match_count && match_index < LINUX_MAX_PRINTED_MATCHES;
+            match_index += 1)
+        {
+            life_pattern_match *match = matches + match_index;
+            printf("%u\t%u\t%s\n", match->row, match->column,
+                   global_transform_names[match->transform]);
+        }
+    }
+    else
+    {
+        fprintf(stderr, "linux_life: can't parse pattern %s\n", pattern_text);
+    }
+    end_temporary_memory(pattern_memory);
+    return(result);
+}
+
+// NOTE(ian): Engine-only run for benchmarking: no rendering, just a big
+// random board stepped as fast as we can. Returns false if the recording
+// couldn't be started or came out incomplete.
+internal bool32
+linux_run_board(linux_memory *memory, int generation_count,
+                u32 rows, u32 columns, life_rule rule, f32 density, u32 block_generations,
+                char *record_path, u32 record_interval,
+                linux_capture *capture, game_graphics_buffer *buffer,
+                bool32 print_stats, char *search_text, linux_counters *counters,
+                bool32 pipelined)
+{
+    life_board *board = Push_Struct(&memory->permanent_arena, life_board);
+    initialize_board(board, &memory->permanent_arena, rows, columns, rule);
+    fill_board_random(board, 0, 0, rows, columns, density, 1);
+    if(print_stats)
+    {
+        printf("generation\tpopulation\tbirths\tdeaths\tmin_row\tmin_column\tmax_row\tmax_column\n");
+    }
+
+    linux_pipeline *pipeline = 0;
+    if(pipelined)
+    {
+        pipeline = Push_Struct(&memory->permanent_arena, linux_pipeline);
+        linux_start_pipeline(pipeline, &memory->permanent_arena, board, capture, buffer);
+        linux_submit_generation(pipeline, board, print_stats, true);
+    }
+    else if(print_stats)
+    {
+        linux_print_stats(board->generation, &board->stats);
+    }
+
+    bool32 result = true;
+    linux_recorder recorder;
+    bool32 recording = false;
+    if(record_path)
+    {
+        recording = linux_start_recorder(&recorder, record_path, rows, columns, record_interval);
+        result = recording;
+        if(recording)
+        {
+            linux_record_generation(&recorder, board);
+        }
+    }
+    life_population_index *index = 0;
+    if(capture && !pipeline && (rows > (u32)buffer->height || columns > (u32)buffer->width))
+    {
+        index = Push_Struct(&memory->permanent_arena, life_population_index);
+        attach_population_index(index, board, &memory->permanent_arena);
+    }
+    if(capture && !pipeline)
+    {
+        linux_capture_board(capture, buffer, board, index);
+    }
+
+    if(block_generations < 1)
+    {
+        block_generations = 1;
+    }
+
+    timespec start = linux_get_wall_clock();
+    for(int generation = 0;
+        global_running && generation < generation_count;
+        generation += block_generations)
+    {
+        u32 count = block_generations;
+        if(generation + (int)count > generation_count)
+        {
+            count = (u32)(generation_count - generation);
+        }
+
+        // NOTE(ian): Don't let a tile pass run past a generation we're
+        // supposed to record or film.
+        if(recording || linux_is_capturing(capture))
+        {
+            u32 until_record = record_interval - (u32)(board->generation % record_interval);
+            if(count > until_record)
+            {
+                count = until_record;
+            }
+        }
+
+        linux_begin_phase(counters, Linux_Phase_Step);
+        if(count > 1)
+        {
+            step_board_blocked(board, count, &memory->transient_arena);
+        }
+        else
+        {
+            step_board(board);
+        }
+        linux_end_phase(counters, Linux_Phase_Step);
+
+        if(recording && (board->generation % record_interval) == 0)
+        {
+            linux_record_generation(&recorder, board);
+        }
+        bool32 film = (linux_is_capturing(capture) && (board->generation % record_interval) == 0);
+        if(pipeline)
+        {
+            linux_submit_generation(pipeline, board, print_stats, film);
+        }
+        else
+        {
+            if(film)
+            {
+                linux_begin_phase(counters, Linux_Phase_Render);
+                linux_capture_board(capture, buffer, board, index);
+                linux_end_phase(counters, Linux_Phase_Render);
+            }
+            if(print_stats)
+            {
+                linux_print_stats(board->generation, &board->stats);
+            }
+        }
+
+        // NOTE(ian): count can come up short of block_generations when we
+        // stop for a recording, so advance by what actually ran.
+        generation -= block_generations - count;
+    }
+    if(pipeline)
+    {
+        linux_stop_pipeline(pipeline);
+    }
+    timespec end = linux_get_wall_clock();
+
+    if(recording)
+    {
+        result = linux_stop_recorder(&recorder);
+    }
+
+    f32 seconds_elapsed = linux_get_seconds_elapsed(start, end);
+    f64 cells = (f64)rows*(f64)columns*(f64)generation_count;
+    printf("%ux%u board, %d generations (%u per pass) in %.03fs, %.03f Gcells/s\n",
+           rows, columns, generation_count, block_generations ? block_generations : 1,
+           seconds_elapsed, cells / (seconds_elapsed * 1e9));
+
+    if(pipeline)
+    {
+        linux_print_pipeline_stats(pipeline);
+    }
+    if(counters)
+    {
+        linux_print_phase_counters(counters, Linux_Phase_Step, "step",
+                                   (f64)generation_count, "generation", cells, "cell");
+        f64 frame_count = (f64)counters->phases[Linux_Phase_Render].run_count;
+        linux_print_phase_counters(counters, Linux_Phase_Render, "render",
+                                   frame_count, "frame",
+                                   frame_count*buffer->width*buffer->height, "pixel");
+    }
+
+    if(search_text)
+    {
+        linux_print_pattern_matches(board, search_text, &memory->transient_arena);
+    }
+    return(result);
+}
+
+internal void
+linux_print_usage(void)
+{
+    fprintf(stderr,
+            "usage: linux_life [-g generations] [-R rule] [-s ROWSxCOLUMNS] [-k generations_per_pass] [-P]\n"
+            "                  [-d density] [-r FILE] [-v FILE] [-n interval] [-F pattern] [-C] [-q]\n"
+            "                  [-p processes [-t shm|socket]] [-I FILE] [-D FILE]\n"
+            "                  [-c FILE] [-f FILE -o FILE [-m stripe_megabytes]]\n"
+            "  -g  number of generations to run (default 100)\n"
+            "  -R  rule, e.g. B3/S23 (the default), B36/S23, /2/3 (Brian's Brain),\n"
+            "      345/2/4 (Star Wars), R5,C0,M1,S34..58,B34..45,NM (Larger than Life)\n"
+            "  -s  step a random board of this size instead of running the game\n"
+            "  -d  with -s or -c, the fraction of cells alive at the start\n"
+            "      (default 0.25)\n"
+            "  -k  with -s, advance this many generations per tile pass\n"
+            "  -P  with -s, print population, births, deaths and the bounding box\n"
+            "      of the live cells after every pass, tab separated\n"
+            "  -C  with -s, count cycles, instructions, cache and branch misses\n"
+            "      while stepping and while filming, per generation and per cell\n"
+            "  -q  with -s, pipeline the run: stats and cycle detection, drawing and\n"
+            "      encoding the video each get a thread while the board steps on\n"
+            "  -r  with -s, record snapshots of the board to FILE in the background\n"
+            "  -D  check the recording FILE made with -r and print each snapshot\n"
+            "      as a -P line; with -n 1 they match the recorded run's\n"
+            "  -I  replay the input log FILE recorded in the window (L), headless,\n"
+            "      and print how long its frames took\n"
+            "  -v  write a video of the run to FILE (- for stdout): Y4M if FILE\n"
+            "      is - or ends in .y4m, a stream of PPM images otherwise\n"
+            "  -F  with -s, list every match of pattern at the end of the run, in\n"
+            "      any orientation; rows split by /, o alive, . dead, ? either\n"
+            "      (a lone glider: ...../..o../...o./.ooo./.....)\n"
+            "  -p  with -s, split the board into bands across this many processes,\n"
+            "      swapping halo rows every -k generations, and print the speed and\n"
+            "      final population\n"
+            "  -t  with -p, how the processes swap rows: shared memory rings (shm,\n"
+            "      the default) or Unix sockets (socket)\n"
+            "  -n  with -s, record and film every this many generations (default 1)\n"
+            "  -c  with -s, write a random board of that size to FILE and exit\n"
+            "  -f  stream the board in grid file FILE from disk instead of memory,\n"
+            "      writing the result to the -o FILE\n"
+            "  -m  rows mapped per stripe while streaming, in megabytes (default 64)\n");
+}
+
+int
+main(int argument_count, char **arguments)
+{
+    global_running = true;
+    global_page_size = (u64)sysconf(_SC_PAGESIZE);
+
+    int generation_count = 100;
+    u32 board_rows = 0;
+    u32 board_columns = 0;
+    u32 block_generations = 1;
+    char *create_path = 0;
+    char *source_path = 0;
+    char *dest_path = 0;
+    u64 stripe_bytes = Megabytes(64);
+    char *record_path = 0;
+    u32 record_interval = 1;
+    char *capture_path = 0;
+    char *replay_path = 0;
+    char *verify_path = 0;
+    char *rule_text = 0;
+    char *search_text = 0;
+    bool32 print_stats = false;
+    bool32 count_events = false;
+    bool32 pipelined = false;
+    f32 density = 0.25f;
+    u32 process_count = 0;
+    linux_transport *transport = &global_ring_transport;
+    life_rule rule = get_conway_rule();
+
+    int option;
+    while((option = getopt(argument_count, arguments, "g:R:s:d:k:PCqF:p:t:c:f:o:m:r:n:v:I:D:")) != -1)
+    {
+        switch(option)
+        {
+            case 'c':
+            {
+                create_path = optarg;
+            } break;
+
+            case 'f':
+            {
+                source_path = optarg;
+            } break;
+
+            case 'o':
+            {
+                dest_path = optarg;
+            } break;
+
+            case 'r':
+            {
+                record_path = optarg;
+            } break;
+
+            case 'D':
+            {
+                verify_path = optarg;
+            } break;
+
+            case 'v':
+            {
+                capture_path = optarg;
+            } break;
+
+            case 'I':
+            {
+                replay_path = optarg;
+            } break;
+
+            case 'n':
+            {
+                record_interval = (u32)atoi(optarg);
+            } break;
+
+            case 'm':
+            {
+                stripe_bytes = Megabytes((u64)atoi(optarg));
+            } break;
+
+            case 'R':
+            {
+                rule_text = optarg;
+                if(!parse_life_rule(rule_text, &rule))
+                {
+                    fprintf(stderr, "linux_life: can't parse rule %s\n", rule_text);
+                    return 1;
+                }
+            } break;
+
+            case 'g':
+            {
+                generation_count = atoi(optarg);
+            } break;
+
+            case 's':
+            {
+                if(sscanf(optarg, "%ux%u", &board_rows, &board_columns) != 2 ||
+                   board_rows == 0 || board_columns == 0)
+                {
+                    linux_print_usage();
+                    return 1;
+                }
+            } break;
+
+            case 'F':
+            {
+                search_text = optarg;
+            } break;
+
+            case 'd':
+            {
+                density = (f32)atof(optarg);
+            } break;
+
+            case 'P':
+            {
+                print_stats = true;
+            } break;
+
+            case 'q':
+            {
+                pipelined = true;
+            } break;
+
+            case 'C':
+            {
+                count_events = true;
+            } break;
+
+            case 'p':
+            {
+                process_count = (u32)atoi(optarg);
+            } break;
+
+            case 't':
+            {
+                if(strcmp(optarg, "shm") == 0)
+                {
+                    transport = &global_ring_transport;
+                }
+                else if(strcmp(optarg, "socket") == 0)
+                {
+                    transport = &global_socket_transport;
+                }
+                else
+                {
+                    linux_print_usage();
+                    return 1;
+                }
+            } break;
+
+            case 'k':
+            {
+                block_generations = (u32)atoi(optarg);
+            } break;
+
+            default:
+            {
+                linux_print_usage();
+                return 1;
+            } break;
+        }
+    }
+
+    if((create_path && !board_rows) ||
+       (record_path && !board_rows) ||
+       (search_text && !board_rows) ||
+       (process_count && (!board_rows || create_path || record_path || capture_path ||
+                          search_text || print_stats || source_path)) ||
+       record_interval == 0 ||
+       (source_path && !dest_path) ||
+       (source_path && capture_path) ||
+       (source_path && rule_text) ||
+       (source_path && strcmp(source_path, dest_path) == 0) ||
+       (replay_path && (board_rows || source_path || rule_text)) ||
+       (verify_path && (board_rows || source_path || replay_path || capture_path || rule_text)) ||
+       (count_events && (!board_rows || create_path || record_path || process_count || pipelined)) ||
+       (pipelined && (!board_rows || create_path || process_count)))
+    {
+        linux_print_usage();
+        return 1;
+    }
+
+    if(create_path)
+    {
+        bool32 written = linux_write_random_grid_file(create_path, board_rows, board_columns,
+                                                      density, 1);
+        return(written ? 0 : 1);
+    }
+
+    if(process_count)
+    {
+        bool32 succeeded = linux_run_distributed(process_count, transport, generation_count,
+                                                 board_rows, board_columns, rule, density,
+                                                 block_generations);
+        return(succeeded ? 0 : 1);
+    }
+
+    // CONFIGURING THE OFFSCREEN GRAPHICS BUFFER
+    game_graphics_buffer graphics_buffer = {};
+    graphics_buffer.width = 960;
+    graphics_buffer.height = 540;
+    graphics_buffer.bytes_per_pixel = 4;
+    graphics_buffer.bytes_per_row = graphics_buffer.width*graphics_buffer.bytes_per_pixel;
+    graphics_buffer.memory = mmap(0, graphics_buffer.bytes_per_row*graphics_buffer.height,
+                                  PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if(graphics_buffer.memory == MAP_FAILED)
+    {
+        fprintf(stderr, "linux_life: could not allocate the graphics buffer\n");
+        return 1;
+    }
+
+    linux_capture capture;
+    linux_capture *capture_pointer = 0;
+    if(capture_path)
+    {
+        if(!linux_start_capture(&capture, capture_path,
+                                graphics_buffer.width, graphics_buffer.height))
+        {
+            return 1;
+        }
+        capture_pointer = &capture;
+    }
+
+    // NOTE(ian): Before the workers, so the counters follow them too, and
+    // after the capture writer, so they don't.
+    linux_counters counters;
+    linux_counters *counters_pointer = 0;
+    if(count_events)
+    {
+        if(!linux_open_counters(&counters))
+        {
+            return 1;
+        }
+        counters_pointer = &counters;
+    }
+
+    linux_start_workers(&global_worker_pool);
+    printf("%u workers on %u NUMA nodes\n",
+           global_worker_pool.worker_count, global_worker_pool.node_count);
+
+    // ALLOCATE MEMORY
+    global_platform.allocate_memory = linux_allocate_memory;
+    global_platform.commit_memory = linux_commit_memory;
+    global_platform.deallocate_memory = linux_deallocate_memory;
+    global_platform.worker_count = global_worker_pool.worker_count;
+    global_platform.run_on_workers = linux_run_on_workers;
+
+    // NOTE(ian): The board lives in the permanent arena. A huge page holds
+    // many bands, so with more than one node it would sit on whichever node
+    // touched it first; then we stick to 4KB pages and first-touch.
+    linux_memory memory = {};
+    initialize_arena(&memory.permanent_arena, Megabytes(64),
+                     (global_worker_pool.node_count > 1) ? 0 : Platform_Memory_Huge_Pages);
+    initialize_arena(&memory.transient_arena, Megabytes(64));
+
+    bool32 replayed = true;
+    bool32 ran = true;
+    if(source_path)
+    {
+        if(!linux_stream_board(&memory.transient_arena, source_path, dest_path,
+                               generation_count, stripe_bytes))
+        {
+            return 1;
+        }
+    }
+    else if(verify_path)
+    {
+        ran = linux_verify_recording(verify_path, &memory.transient_arena);
+    }
+    else if(replay_path)
+    {
+        replayed = linux_replay_input(replay_path, &memory.transient_arena,
+                                      &graphics_buffer, capture_pointer);
+    }
+    else if(board_rows)
+    {
+        ran = linux_run_board(&memory, generation_count, board_rows, board_columns, rule, density,
+                              block_generations,
+                              record_path, record_interval, capture_pointer, &graphics_buffer,
+                              print_stats, search_text, counters_pointer, pipelined);
+    }
+    else
+    {
+        game_memory game = {};
+        game.is_initialized = false;
+        game.rule = rule_text;
+
+        game_input inputs[2] = {};
+        game_input *old_input = &inputs[0];
+        game_input *new_input = &inputs[1];
+        new_input->scaling_factor = 1;
+        new_input->animation_speed_factor = 1.0f;
+        new_input->run_simulation = true;
+
+        timespec start = linux_get_wall_clock();
+        for(int generation = 0;
+            global_running && generation < generation_count;
+            generation += 1)
+        {
+            game_run_frame(&graphics_buffer, &game, new_input, old_input);
+            if(capture_pointer)
+            {
+                linux_capture_frame(capture_pointer, &graphics_buffer);
+            }
+        }
+        timespec end = linux_get_wall_clock();
+
+        f32 seconds_elapsed = linux_get_seconds_elapsed(start, end);
+        printf("%d generations in %.03fs\n", generation_count, seconds_elapsed);
+    }
+
+    bool32 captured = true;
+    if(capture_pointer)
+    {
+        captured = linux_stop_capture(capture_pointer);
+    }
+
+    linux_print_arena_stats("permanent", &memory.permanent_arena);
+    linux_print_arena_stats("transient", &memory.transient_arena);
+
+    return((captured && replayed && ran) ? 0 : 1);
+}
@@ -0,0 +1,406 @@
+// NOTE(ian): -q runs the -s loop as a pipeline, a thread per stage:
+//     simulate   the calling thread (with the workers): steps a pass, then
+//                copies the live cells into a free generation buffer
+//     analyze    prints the -P line and watches for the board repeating
+//     rasterize  draws the overview of the copy into the buffer's own frame
+//     encode     converts the frame for the capture writer, which writes it
+// The buffers come from a fixed pool and go round simulate, analyze,
+// rasterize, encode and back to the pool through bounded single producer,
+// single consumer queues, so nothing is allocated once it's going and the
+// simulation only waits when every buffer is still downstream. Throughput is
+// then the slowest stage's rather than the sum of them; the busy times
+// printed at the end say which stage that is. Without -v the buffers go
+// straight from analyze back to the pool.
+//
+// The stages can't use the workers (the pool runs one job at a time, and the
+// simulation has it), so rasterize counts its pixels straight off the copy
+// instead of keeping a population index.
+
+#define LINUX_PIPELINE_BUFFER_COUNT 4
+#define LINUX_PIPELINE_QUEUE_SIZE 4
+#define LINUX_PIPELINE_HISTORY_COUNT 64
+
+struct linux_generation
+{
+    u64 generation;
+    life_stats stats;
+    bool32 report; // NOTE(ian): print its -P line
+    bool32 film;   // NOTE(ian): rasterize and encode it
+
+    life_grid grid; // NOTE(ian): live cells only
+    game_graphics_buffer frame;
+};
+
+// NOTE(ian): Like linux_ring, but of buffer pointers and inside one process.
+// A null pointer means the stream is over.
+struct linux_generation_queue
+{
+    u32 write_count;
+    u8 write_padding[60];
+    u32 read_count;
+    u8 read_padding[60];
+    linux_generation *slots[LINUX_PIPELINE_QUEUE_SIZE];
+};
+
+struct linux_pipeline_history
+{
+    u64 hash;
+    u64 generation;
+    life_stats stats;
+};
+
+struct linux_pipeline
+{
+    linux_capture *capture;
+    bool32 detect_cycles;
+
+    linux_generation generations[LINUX_PIPELINE_BUFFER_COUNT];
+    linux_generation_queue free_queue;
+    linux_generation_queue analyze_queue;
+    linux_generation_queue rasterize_queue;
+    linux_generation_queue encode_queue;
+
+    pthread_t analyze_thread;
+    pthread_t rasterize_thread;
+    pthread_t encode_thread;
+    u32 *overview_counts;
+
+    // NOTE(ian): Analyze's own. A cycle is found when a generation hashes
+    // the same as one of the last LINUX_PIPELINE_HISTORY_COUNT copies, with
+    // the same population and bounding box. Copies are a pass apart, so that
+    // gap is only a multiple of the period; cycle_board steps the copy one
+    // generation at a time to find the period itself. cycle_start is the
+    // first copy seen in the cycle, which with -k can be up to a pass after
+    // the board actually settled into it.
+    u32 history_count;
+    linux_pipeline_history history[LINUX_PIPELINE_HISTORY_COUNT];
+    life_board cycle_board;
+    u64 cycle_start;
+    u64 cycle_period; // NOTE(ian): 0 until a cycle is found
+
+    f32 analyze_seconds;
+    f32 rasterize_seconds;
+    f32 encode_seconds;
+    f32 wait_seconds; // NOTE(ian): simulate waiting for a free buffer
+    u64 wait_count;
+};
+
+internal void
+linux_push_generation(linux_generation_queue *queue, linux_generation *generation)
+{
+    u32 write_count = queue->write_count;
+    for(;;)
+    {
+        u32 read_count = __atomic_load_n(&queue->read_count, __ATOMIC_ACQUIRE);
+        if(write_count - read_count < LINUX_PIPELINE_QUEUE_SIZE)
+        {
+            break;
+        }
+        linux_futex_wait(&queue->read_count, read_count);
+    }
+
+    queue->slots[write_count % LINUX_PIPELINE_QUEUE_SIZE] = generation;
+    __atomic_store_n(&queue->write_count, write_count + 1, __ATOMIC_RELEASE);
+    linux_futex_wake(&queue->write_count);
+}
+
+internal linux_generation *
+linux_pop_generation(linux_generation_queue *queue)
+{
+    u32 read_count = queue->read_count;
+    for(;;)
+    {
+        u32 write_count = __atomic_load_n(&queue->write_count, __ATOMIC_ACQUIRE);
+        if(write_count != read_count)
+        {
+            break;
+        }
+        linux_futex_wait(&queue->write_count, write_count);
+    }
+
+    linux_generation *result = queue->slots[read_count % LINUX_PIPELINE_QUEUE_SIZE];
+    __atomic_store_n(&queue->read_count, read_count + 1, __ATOMIC_RELEASE);
+    linux_futex_wake(&queue->read_count);
+    return(result);
+}
+
+internal u64
+linux_hash_grid(life_grid *grid)
+{
+    u64 hash = 0;
+    u64 *words = grid->words;
+    u64 word_count = (u64)grid->rows*grid->words_per_row;
+    for(u64 word_index = 0;
+        word_index < word_count;
+        word_index += 1)
+    {
+        hash = (hash ^ words[word_index])*0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 29;
+    }
+    return(hash);
+}
+
+internal bool32
+linux_stats_are_equal(life_stats *a, life_stats *b)
+{
+    bool32 result = (a->population == b->population &&
+                     (a->population == 0 ||
+                      (a->min_row == b->min_row && a->max_row == b->max_row &&
+                       a->min_column == b->min_column && a->max_column == b->max_column)));
+    return(result);
+}
+
+// NOTE(ian): The workers belong to simulate, so this steps the whole board
+// on the analyze thread, as if it were all the first band.
+internal void
+linux_step_cycle_board(life_board *board)
+{
+    life_band *band = board->bands;
+    clear_stats(&band->stats);
+    step_board_rows(board, band, 0, board->grid.rows);
+
+    life_grid swap = board->grid;
+    board->grid = board->temp_grid;
+    board->temp_grid = swap;
+}
+
+// NOTE(ian): grid is known to repeat after sampled_period generations.
+// Returns the smallest period that divides it, or 0 if the grid doesn't
+// actually come back (the hashes collided).
+internal u64
+linux_find_cycle_period(life_board *board, life_grid *grid, u64 sampled_period)
+{
+    u64 size = (u64)grid->rows*grid->words_per_row*sizeof(u64);
+    memcpy(board->grid.words, grid->words, size);
+
+    u64 result = 0;
+    for(u64 period = 1;
+        period <= sampled_period;
+        period += 1)
+    {
+        linux_step_cycle_board(board);
+        if((sampled_period % period) == 0 && memcmp(board->grid.words, grid->words, size) == 0)
+        {
+            result = period;
+            break;
+        }
+    }
+    return(result);
+}
+
+internal void
+linux_analyze_generation(linux_pipeline *pipeline, linux_generation *generation)
+{
+    if(generation->report)
+    {
+        linux_print_stats(generation->generation, &generation->stats);
+    }
+
+    if(pipeline->detect_cycles && !pipeline->cycle_period)
+    {
+        u64 hash = linux_hash_grid(&generation->grid);
+        u32 history_count = (pipeline->history_count < LINUX_PIPELINE_HISTORY_COUNT) ?
+            pipeline->history_count : LINUX_PIPELINE_HISTORY_COUNT;
+        for(u32 history_index = 0;
+            history_index < history_count;
+            history_index += 1)
+        {
+            linux_pipeline_history *earlier = pipeline->history + history_index;
+            if(earlier->hash == hash && linux_stats_are_equal(&earlier->stats, &generation->stats))
+            {
+                pipeline->cycle_period = linux_find_cycle_period(&pipeline->cycle_board, &generation->grid,
+                                                                 generation->generation - earlier->generation);
+                if(pipeline->cycle_period)
+                {
+                    pipeline->cycle_start = earlier->generation;
+                    break;
+                }
+            }
+        }
+
+        linux_pipeline_history *entry = (pipeline->history +
+                                         pipeline->history_count % LINUX_PIPELINE_HISTORY_COUNT);
+        entry->hash = hash;
+        entry->generation = generation->generation;
+        entry->stats = generation->stats;
+        pipeline->history_count += 1;
+    }
+}
+
+internal void *
+linux_analyze_thread_proc(void *data)
+{
+    linux_pipeline *pipeline = (linux_pipeline *)data;
+    linux_generation_queue *next_queue = (pipeline->capture ?
+                                          &pipeline->rasterize_queue : &pipeline->free_queue);
+    for(;;)
+    {
+        linux_generation *generation = linux_pop_generation(&pipeline->analyze_queue);
+        if(!generation)
+        {
+            if(pipeline->capture)
+            {
+                linux_push_generation(next_queue, 0);
+            }
+            break;
+        }
+
+        timespec start = linux_get_wall_clock();
+        linux_analyze_generation(pipeline, generation);
+        pipeline->analyze_seconds += linux_get_seconds_elapsed(start, linux_get_wall_clock());
+
+        linux_push_generation(next_queue, generation);
+    }
+    return(0);
+}
+
+internal void *
+linux_rasterize_thread_proc(void *data)
+{
+    linux_pipeline *pipeline = (linux_pipeline *)data;
+    color on_color = {0.0f, 0.0f, 0.0f};
+    color off_color = {1.0f, 1.0f, 1.0f};
+    for(;;)
+    {
+        linux_generation *generation = linux_pop_generation(&pipeline->rasterize_queue);
+        if(!generation)
+        {
+            linux_push_generation(&pipeline->encode_queue, 0);
+            break;
+        }
+
+        if(generation->film)
+        {
+            timespec start = linux_get_wall_clock();
+            draw_grid_overview_counted(&generation->frame, &generation->grid, on_color, off_color,
+                                       pipeline->overview_counts);
+            pipeline->rasterize_seconds += linux_get_seconds_elapsed(start, linux_get_wall_clock());
+        }
+        linux_push_generation(&pipeline->encode_queue, generation);
+    }
+    return(0);
+}
+
+internal void *
+linux_encode_thread_proc(void *data)
+{
+    linux_pipeline *pipeline = (linux_pipeline *)data;
+    for(;;)
+    {
+        linux_generation *generation = linux_pop_generation(&pipeline->encode_queue);
+        if(!generation)
+        {
+            break;
+        }
+
+        if(generation->film)
+        {
+            // NOTE(ian): Includes any wait for a free capture slot, which is
+            // the writer's time showing through.
+            timespec start = linux_get_wall_clock();
+            linux_capture_frame(pipeline->capture, &generation->frame);
+            pipeline->encode_seconds += linux_get_seconds_elapsed(start, linux_get_wall_clock());
+        }
+        linux_push_generation(&pipeline->free_queue, generation);
+    }
+    return(0);
+}
+
+// NOTE(ian): Everything is pushed on arena up front. capture can be null.
+internal void
+linux_start_pipeline(linux_pipeline *pipeline, memory_arena *arena, life_board *board,
+                     linux_capture *capture, game_graphics_buffer *buffer)
+{
+    *pipeline = {};
+    pipeline->capture = capture;
+
+    // NOTE(ian): Only the live cells are copied, and with more states than
+    // that the same live cells don't mean the same board.
+    pipeline->detect_cycles = (board->age_plane_count == 0);
+    if(pipeline->detect_cycles)
+    {
+        initialize_board(&pipeline->cycle_board, arena, board->grid.rows, board->grid.columns,
+                         board->rule);
+    }
+
+    for(u32 generation_index = 0;
+        generation_index < LINUX_PIPELINE_BUFFER_COUNT;
+        generation_index += 1)
+    {
+        linux_generation *generation = pipeline->generations + generation_index;
+        push_grid(&generation->grid, arena, board->grid.rows, board->grid.columns);
+        if(capture)
+        {
+            generation->frame = *buffer;
+            generation->frame.memory = Push_Size(arena, (u64)buffer->bytes_per_row*buffer->height,
+                                                 ARENA_ROW_ALIGNMENT);
+        }
+        linux_push_generation(&pipeline->free_queue, generation);
+    }
+
+    pthread_create(&pipeline->analyze_thread, 0, linux_analyze_thread_proc, pipeline);
+    if(capture)
+    {
+        pipeline->overview_counts = Push_Array(arena, buffer->width, u32);
+        pthread_create(&pipeline->rasterize_thread, 0, linux_rasterize_thread_proc, pipeline);
+        pthread_create(&pipeline->encode_thread, 0, linux_encode_thread_proc, pipeline);
+    }
+}
+
+// NOTE(ian): The simulate stage's end of things: hands the board as it
+// stands down the pipeline, waiting for a buffer if they're all in use.
+internal void
+linux_submit_generation(linux_pipeline *pipeline, life_board *board, bool32 report, bool32 film)
+{
+    linux_generation *generation = 0;
+    if(__atomic_load_n(&pipeline->free_queue.write_count, __ATOMIC_ACQUIRE) ==
+       pipeline->free_queue.read_count)
+    {
+        timespec start = linux_get_wall_clock();
+        generation = linux_pop_generation(&pipeline->free_queue);
+        pipeline->wait_seconds += linux_get_seconds_elapsed(start, linux_get_wall_clock());
+        pipeline->wait_count += 1;
+    }
+    else
+    {
+        generation = linux_pop_generation(&pipeline->free_queue);
+    }
+
+    generation->generation = board->generation;
+    generation->stats = board->stats;
+    generation->report = report;
+    generation->film = film && pipeline->capture;
+    memcpy(generation->grid.words, board->grid.words,
+           (u64)board->grid.rows*board->grid.words_per_row*sizeof(u64));
+
+    linux_push_generation(&pipeline->analyze_queue, generation);
+}
+
+// NOTE(ian): Waits for everything submitted to come out the other end.
+internal void
+linux_stop_pipeline(linux_pipeline *pipeline)
+{
+    linux_push_generation(&pipeline->analyze_queue, 0);
+    pthread_join(pipeline->analyze_thread, 0);
+    if(pipeline->capture)
+    {
+        pthread_join(pipeline->rasterize_thread, 0);
+        pthread_join(pipeline->encode_thread, 0);
+    }
+}
+
+internal void
+linux_print_pipeline_stats(linux_pipeline *pipeline)
+{
+    printf("pipeline: analyze %.03fs, rasterize %.03fs, encode %.03fs busy; "
+           "simulate waited %.03fs for a buffer %llu times\n",
+           pipeline->analyze_seconds, pipeline->rasterize_seconds, pipeline->encode_seconds,
+           pipeline->wait_seconds, (unsigned long long)pipeline->wait_count);
+    if(pipeline->cycle_period)
+    {
+        printf("generation %llu repeats generation %llu (period %llu)\n",
+               (unsigned long long)(pipeline->cycle_start + pipeline->cycle_period),
+               (unsigned long long)pipeline->cycle_start,
+               (unsigned long long)pipeline->cycle_period);
+    }
+}
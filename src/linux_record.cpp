@@ -0,0 +1,796 @@
+// NOTE(ian): Background recording of every Nth generation (format in
+// life_record.h). The simulation thread only ever memcpys the grid into a
+// free snapshot slot and hands it over; an encoder thread delta-codes it
+// against the snapshot before and writes the result asynchronously, through
+// io_uring when the kernel lets us have one and a writer thread otherwise.
+//
+// linux_verify_recording reads a recording back and prints what's in it.
+//
+// If the encoder falls so far behind that every slot is busy, the simulation
+// waits for it (and counts the wait) rather than skipping the snapshot: a
+// recording with gaps in it is no good for replay. A slot always comes free,
+// since at most one is kept as the encoder's previous snapshot.
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+#define LINUX_RECORD_SLOT_COUNT 4
+#define LINUX_RECORD_KEYFRAME_INTERVAL 64
+#define LINUX_WRITE_BUFFER_COUNT 2
+// NOTE(ian): An sqe's length is 32 bits, and Linux won't write more than
+// about 2GB at once anyway; bigger buffers go out as several short writes.
+#define LINUX_MAX_WRITE_SUBMISSION Gigabytes(1)
+
+enum linux_slot_state
+{
+    Linux_Slot_Free,
+    Linux_Slot_Filling,
+    Linux_Slot_Ready,
+    Linux_Slot_Encoding,
+    Linux_Slot_Previous, // NOTE(ian): kept as the base for the next delta
+};
+
+struct linux_io_uring
+{
+    int handle;
+
+    u32 *sq_head;
+    u32 *sq_tail;
+    u32 *sq_mask;
+    u32 *sq_array;
+    io_uring_sqe *sqes;
+
+    u32 *cq_head;
+    u32 *cq_tail;
+    u32 *cq_mask;
+    io_uring_cqe *cqes;
+
+    void *sq_mapping;
+    u64 sq_mapping_size;
+    void *cq_mapping;
+    u64 cq_mapping_size;
+    u64 sqe_mapping_size;
+};
+
+struct linux_write_buffer
+{
+    u8 *memory;
+    u64 size;
+    u64 offset;
+    u64 written;
+    bool32 in_flight;
+};
+
+// NOTE(ian): Writes whole buffers at increasing file offsets without the
+// caller waiting for them. A buffer can be refilled once
+// linux_wait_for_write says it has landed.
+struct linux_async_writer
+{
+    int file;
+    u64 offset;
+    bool32 failed;
+
+    bool32 use_io_uring;
+    linux_io_uring ring;
+
+    // NOTE(ian): Used when io_uring isn't available.
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    u32 queue[LINUX_WRITE_BUFFER_COUNT];
+    u32 queue_read;
+    u32 queue_write;
+    bool32 stopping;
+
+    linux_write_buffer buffers[LINUX_WRITE_BUFFER_COUNT];
+};
+
+struct linux_recorder
+{
+    life_record_header header;
+    u64 word_count;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    pthread_t encoder_thread;
+    bool32 stopping;
+
+    u64 *slots[LINUX_RECORD_SLOT_COUNT];
+    u64 slot_generations[LINUX_RECORD_SLOT_COUNT];
+    linux_slot_state slot_states[LINUX_RECORD_SLOT_COUNT];
+    u32 ready_queue[LINUX_RECORD_SLOT_COUNT];
+    u32 ready_read;
+    u32 ready_write;
+
+    linux_async_writer writer;
+
+    u64 recorded_count;
+    u64 stall_count;
+    u64 raw_bytes;
+    u64 encoded_bytes;
+};
+
+//
+// NOTE(ian): io_uring, straight on the syscalls so we don't need liburing.
+//
+
+internal bool32
+linux_setup_io_uring(linux_io_uring *ring, u32 entry_count)
+{
+    io_uring_params params = {};
+    ring->handle = (int)syscall(__NR_io_uring_setup, entry_count, &params);
+    if(ring->handle < 0)
+    {
+        return(false);
+    }
+
+    // NOTE(ian): IORING_OP_WRITE came in with 5.6, same as the probe, so an
+    // older kernel fails the probe and gets the writer thread instead of a
+    // ring whose every write comes back -EINVAL.
+    u64 probe_storage[(sizeof(io_uring_probe) + 256*sizeof(io_uring_probe_op)) / sizeof(u64)] = {};
+    io_uring_probe *probe = (io_uring_probe *)probe_storage;
+    if(syscall(__NR_io_uring_register, ring->handle, IORING_REGISTER_PROBE, probe, 256) < 0 ||
+       probe->last_op < IORING_OP_WRITE ||
+       !(probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED))
+    {
+        close(ring->handle);
+        return(false);
+    }
+
+    ring->sq_mapping_size = params.sq_off.array + params.sq_entries*sizeof(u32);
+    ring->cq_mapping_size = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+    ring->sqe_mapping_size = params.sq_entries*sizeof(io_uring_sqe);
+
+    ring->sq_mapping = mmap(0, ring->sq_mapping_size, PROT_READ|PROT_WRITE,
+                            MAP_SHARED|MAP_POPULATE, ring->handle, IORING_OFF_SQ_RING);
+    ring->cq_mapping = mmap(0, ring->cq_mapping_size, PROT_READ|PROT_WRITE,
+                            MAP_SHARED|MAP_POPULATE, ring->handle, IORING_OFF_CQ_RING);
+    void *sqe_mapping = mmap(0, ring->sqe_mapping_size, PROT_READ|PROT_WRITE,
+                             MAP_SHARED|MAP_POPULATE, ring->handle, IORING_OFF_SQES);
+    if(ring->sq_mapping == MAP_FAILED || ring->cq_mapping == MAP_FAILED || sqe_mapping == MAP_FAILED)
+    {
+        close(ring->handle);
+        return(false);
+    }
+
+    u8 *sq = (u8 *)ring->sq_mapping;
+    ring->sq_head = (u32 *)(sq + params.sq_off.head);
+    ring->sq_tail = (u32 *)(sq + params.sq_off.tail);
+    ring->sq_mask = (u32 *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (u32 *)(sq + params.sq_off.array);
+    ring->sqes = (io_uring_sqe *)sqe_mapping;
+
+    u8 *cq = (u8 *)ring->cq_mapping;
+    ring->cq_head = (u32 *)(cq + params.cq_off.head);
+    ring->cq_tail = (u32 *)(cq + params.cq_off.tail);
+    ring->cq_mask = (u32 *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    return(true);
+}
+
+internal void
+linux_close_io_uring(linux_io_uring *ring)
+{
+    munmap(ring->sqes, ring->sqe_mapping_size);
+    munmap(ring->cq_mapping, ring->cq_mapping_size);
+    munmap(ring->sq_mapping, ring->sq_mapping_size);
+    close(ring->handle);
+}
+
+// NOTE(ian): Retries when interrupted or when the kernel is short of memory
+// for the moment. Any other error means the ring is no good to us.
+internal bool32
+linux_enter_io_uring(linux_io_uring *ring, u32 submit_count, u32 wait_count, u32 flags)
+{
+    for(;;)
+    {
+        long result = syscall(__NR_io_uring_enter, ring->handle, submit_count, wait_count, flags, 0, 0);
+        if(result >= 0)
+        {
+            return(true);
+        }
+        if(errno != EINTR && errno != EAGAIN)
+        {
+            return(false);
+        }
+    }
+}
+
+internal bool32
+linux_submit_io_uring_write(linux_io_uring *ring, int file, linux_write_buffer *buffer, u32 buffer_index)
+{
+    u32 tail = *ring->sq_tail;
+    u32 index = tail & *ring->sq_mask;
+
+    io_uring_sqe *sqe = ring->sqes + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = file;
+    u64 size = buffer->size - buffer->written;
+    if(size > LINUX_MAX_WRITE_SUBMISSION)
+    {
+        size = LINUX_MAX_WRITE_SUBMISSION;
+    }
+    sqe->addr = (u64)(buffer->memory + buffer->written);
+    sqe->len = (u32)size;
+    sqe->off = buffer->offset + buffer->written;
+    sqe->user_data = buffer_index;
+    ring->sq_array[index] = index;
+
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    bool32 result = linux_enter_io_uring(ring, 1, 0, 0);
+    return(result);
+}
+
+//
+// NOTE(ian): The async writer.
+//
+
+internal void *
+linux_writer_thread_proc(void *parameter)
+{
+    linux_async_writer *writer = (linux_async_writer *)parameter;
+    for(;;)
+    {
+        pthread_mutex_lock(&writer->mutex);
+        while(writer->queue_read == writer->queue_write && !writer->stopping)
+        {
+            pthread_cond_wait(&writer->condition, &writer->mutex);
+        }
+        if(writer->queue_read == writer->queue_write)
+        {
+            pthread_mutex_unlock(&writer->mutex);
+            break;
+        }
+        u32 buffer_index = writer->queue[writer->queue_read % LINUX_WRITE_BUFFER_COUNT];
+        pthread_mutex_unlock(&writer->mutex);
+
+        linux_write_buffer *buffer = writer->buffers + buffer_index;
+        while(buffer->written < buffer->size)
+        {
+            ssize_t written = pwrite(writer->file, buffer->memory + buffer->written,
+                                     buffer->size - buffer->written,
+                                     (off_t)(buffer->offset + buffer->written));
+            if(written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if(written <= 0)
+            {
+                writer->failed = true;
+                break;
+            }
+            buffer->written += (u64)written;
+        }
+
+        pthread_mutex_lock(&writer->mutex);
+        writer->queue_read += 1;
+        buffer->in_flight = false;
+        pthread_cond_broadcast(&writer->condition);
+        pthread_mutex_unlock(&writer->mutex);
+    }
+    return(0);
+}
+
+internal void
+linux_free_write_buffers(linux_async_writer *writer)
+{
+    for(u32 buffer_index = 0;
+        buffer_index < LINUX_WRITE_BUFFER_COUNT;
+        buffer_index += 1)
+    {
+        free(writer->buffers[buffer_index].memory);
+        writer->buffers[buffer_index].memory = 0;
+    }
+}
+
+internal bool32
+linux_start_writer(linux_async_writer *writer, int file, u64 buffer_size)
+{
+    writer->file = file;
+    writer->offset = 0;
+    writer->failed = false;
+    bool32 allocated = true;
+    for(u32 buffer_index = 0;
+        buffer_index < LINUX_WRITE_BUFFER_COUNT;
+        buffer_index += 1)
+    {
+        linux_write_buffer *buffer = writer->buffers + buffer_index;
+        buffer->memory = (u8 *)malloc(buffer_size);
+        buffer->in_flight = false;
+        if(!buffer->memory)
+        {
+            allocated = false;
+        }
+    }
+    if(!allocated)
+    {
+        linux_free_write_buffers(writer);
+        return(false);
+    }
+
+    writer->use_io_uring = linux_setup_io_uring(&writer->ring, LINUX_WRITE_BUFFER_COUNT);
+    if(!writer->use_io_uring)
+    {
+        pthread_mutex_init(&writer->mutex, 0);
+        pthread_cond_init(&writer->condition, 0);
+        writer->queue_read = 0;
+        writer->queue_write = 0;
+        writer->stopping = false;
+        pthread_create(&writer->thread, 0, linux_writer_thread_proc, writer);
+    }
+    return(true);
+}
+
+internal void
+linux_wait_for_write(linux_async_writer *writer, u32 buffer_index)
+{
+    linux_write_buffer *buffer = writer->buffers + buffer_index;
+    if(writer->use_io_uring)
+    {
+        linux_io_uring *ring = &writer->ring;
+        while(buffer->in_flight)
+        {
+            u32 head = *ring->cq_head;
+            if(head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+            {
+                if(!linux_enter_io_uring(ring, 0, 1, IORING_ENTER_GETEVENTS))
+                {
+                    // NOTE(ian): Nothing more is coming back, so give up on
+                    // everything still out.
+                    writer->failed = true;
+                    for(u32 other_index = 0;
+                        other_index < LINUX_WRITE_BUFFER_COUNT;
+                        other_index += 1)
+                    {
+                        writer->buffers[other_index].in_flight = false;
+                    }
+                }
+                continue;
+            }
+
+            io_uring_cqe *cqe = ring->cqes + (head & *ring->cq_mask);
+            linux_write_buffer *done = writer->buffers + cqe->user_data;
+            u32 done_index = (u32)cqe->user_data;
+            s32 result = cqe->res;
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+            if(result <= 0)
+            {
+                writer->failed = true;
+                done->in_flight = false;
+            }
+            else
+            {
+                // NOTE(ian): Short writes are legal; send the rest.
+                done->written += (u64)result;
+                if(done->written < done->size)
+                {
+                    if(!linux_submit_io_uring_write(ring, writer->file, done, done_index))
+                    {
+                        writer->failed = true;
+                        done->in_flight = false;
+                    }
+                }
+                else
+                {
+                    done->in_flight = false;
+                }
+            }
+        }
+    }
+    else
+    {
+        pthread_mutex_lock(&writer->mutex);
+        while(buffer->in_flight)
+        {
+            pthread_cond_wait(&writer->condition, &writer->mutex);
+        }
+        pthread_mutex_unlock(&writer->mutex);
+    }
+}
+
+internal void
+linux_submit_write(linux_async_writer *writer, u32 buffer_index, u64 size)
+{
+    linux_write_buffer *buffer = writer->buffers + buffer_index;
+    buffer->size = size;
+    buffer->offset = writer->offset;
+    buffer->written = 0;
+    buffer->in_flight = true;
+    writer->offset += size;
+
+    if(writer->use_io_uring)
+    {
+        // NOTE(ian): A submit that didn't go through may have left its sqe
+        // in the ring, so once anything has failed nothing more goes in.
+        if(writer->failed ||
+           !linux_submit_io_uring_write(&writer->ring, writer->file, buffer, buffer_index))
+        {
+            writer->failed = true;
+            buffer->in_flight = false;
+        }
+    }
+    else
+    {
+        pthread_mutex_lock(&writer->mutex);
+        writer->queue[writer->queue_write % LINUX_WRITE_BUFFER_COUNT] = buffer_index;
+        writer->queue_write += 1;
+        pthread_cond_broadcast(&writer->condition);
+        pthread_mutex_unlock(&writer->mutex);
+    }
+}
+
+internal void
+linux_stop_writer(linux_async_writer *writer)
+{
+    for(u32 buffer_index = 0;
+        buffer_index < LINUX_WRITE_BUFFER_COUNT;
+        buffer_index += 1)
+    {
+        linux_wait_for_write(writer, buffer_index);
+    }
+
+    if(writer->use_io_uring)
+    {
+        linux_close_io_uring(&writer->ring);
+    }
+    else
+    {
+        pthread_mutex_lock(&writer->mutex);
+        writer->stopping = true;
+        pthread_cond_broadcast(&writer->condition);
+        pthread_mutex_unlock(&writer->mutex);
+        pthread_join(writer->thread, 0);
+    }
+
+    linux_free_write_buffers(writer);
+}
+
+//
+// NOTE(ian): The recorder.
+//
+
+internal void *
+linux_encoder_thread_proc(void *parameter)
+{
+    linux_recorder *recorder = (linux_recorder *)parameter;
+    linux_async_writer *writer = &recorder->writer;
+
+    s32 previous_slot = -1;
+    u32 next_buffer = 0;
+    u64 snapshot_index = 0;
+    for(;;)
+    {
+        pthread_mutex_lock(&recorder->mutex);
+        while(recorder->ready_read == recorder->ready_write && !recorder->stopping)
+        {
+            pthread_cond_wait(&recorder->condition, &recorder->mutex);
+        }
+        if(recorder->ready_read == recorder->ready_write)
+        {
+            pthread_mutex_unlock(&recorder->mutex);
+            break;
+        }
+        u32 slot = recorder->ready_queue[recorder->ready_read % LINUX_RECORD_SLOT_COUNT];
+        recorder->ready_read += 1;
+        recorder->slot_states[slot] = Linux_Slot_Encoding;
+        pthread_mutex_unlock(&recorder->mutex);
+
+        linux_wait_for_write(writer, next_buffer);
+        linux_write_buffer *buffer = writer->buffers + next_buffer;
+
+        bool32 keyframe = (previous_slot < 0) ||
+                          ((snapshot_index % recorder->header.keyframe_interval) == 0);
+        u64 *previous = keyframe ? 0 : recorder->slots[previous_slot];
+
+        life_snapshot_header *snapshot = (life_snapshot_header *)buffer->memory;
+        snapshot->magic = LIFE_SNAPSHOT_MAGIC;
+        snapshot->flags = keyframe ? Life_Snapshot_Keyframe : 0;
+        snapshot->generation = recorder->slot_generations[slot];
+        snapshot->size = encode_snapshot(recorder->slots[slot], previous, recorder->word_count,
+                                         buffer->memory + sizeof(life_snapshot_header));
+        u64 size = sizeof(life_snapshot_header) + snapshot->size;
+        linux_submit_write(writer, next_buffer, size);
+        next_buffer = (next_buffer + 1) % LINUX_WRITE_BUFFER_COUNT;
+
+        pthread_mutex_lock(&recorder->mutex);
+        if(previous_slot >= 0)
+        {
+            recorder->slot_states[previous_slot] = Linux_Slot_Free;
+            pthread_cond_broadcast(&recorder->condition);
+        }
+        recorder->slot_states[slot] = Linux_Slot_Previous;
+        recorder->recorded_count += 1;
+        recorder->encoded_bytes += size;
+        pthread_mutex_unlock(&recorder->mutex);
+
+        previous_slot = (s32)slot;
+        snapshot_index += 1;
+    }
+
+    return(0);
+}
+
+internal void
+linux_free_record_slots(linux_recorder *recorder)
+{
+    for(u32 slot = 0;
+        slot < LINUX_RECORD_SLOT_COUNT;
+        slot += 1)
+    {
+        free(recorder->slots[slot]);
+        recorder->slots[slot] = 0;
+    }
+}
+
+internal bool32
+linux_start_recorder(linux_recorder *recorder, const char *path,
+                     u32 rows, u32 columns, u32 interval)
+{
+    int file = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if(file < 0)
+    {
+        fprintf(stderr, "linux_life: could not create %s: %s\n", path, strerror(errno));
+        return(false);
+    }
+
+    recorder->header = {};
+    recorder->header.magic = LIFE_RECORD_MAGIC;
+    recorder->header.version = LIFE_RECORD_VERSION;
+    recorder->header.rows = rows;
+    recorder->header.columns = columns;
+    recorder->header.interval = interval;
+    recorder->header.keyframe_interval = LINUX_RECORD_KEYFRAME_INTERVAL;
+    recorder->word_count = get_snapshot_word_count(rows, columns);
+
+    pthread_mutex_init(&recorder->mutex, 0);
+    pthread_cond_init(&recorder->condition, 0);
+    recorder->stopping = false;
+    recorder->ready_read = 0;
+    recorder->ready_write = 0;
+    recorder->recorded_count = 0;
+    recorder->stall_count = 0;
+    recorder->raw_bytes = 0;
+    recorder->encoded_bytes = 0;
+
+    bool32 allocated = true;
+    for(u32 slot = 0;
+        slot < LINUX_RECORD_SLOT_COUNT;
+        slot += 1)
+    {
+        recorder->slots[slot] = (u64 *)malloc(recorder->word_count*sizeof(u64));
+        recorder->slot_states[slot] = Linux_Slot_Free;
+        if(!recorder->slots[slot])
+        {
+            allocated = false;
+        }
+    }
+
+    u64 buffer_size = sizeof(life_snapshot_header) + get_max_encoded_snapshot_size(recorder->word_count);
+    if(buffer_size < sizeof(life_record_header))
+    {
+        buffer_size = sizeof(life_record_header);
+    }
+    if(!allocated || !linux_start_writer(&recorder->writer, file, buffer_size))
+    {
+        fprintf(stderr, "linux_life: not enough memory to record %ux%u\n", rows, columns);
+        linux_free_record_slots(recorder);
+        pthread_cond_destroy(&recorder->condition);
+        pthread_mutex_destroy(&recorder->mutex);
+        close(file);
+        return(false);
+    }
+
+    // NOTE(ian): The file header goes out through the writer like everything
+    // else so the offsets stay in order.
+    memcpy(recorder->writer.buffers[0].memory, &recorder->header, sizeof(recorder->header));
+    linux_submit_write(&recorder->writer, 0, sizeof(recorder->header));
+    linux_wait_for_write(&recorder->writer, 0);
+
+    pthread_create(&recorder->encoder_thread, 0, linux_encoder_thread_proc, recorder);
+    return(true);
+}
+
+// NOTE(ian): Called from the simulation thread.
+internal void
+linux_record_generation(linux_recorder *recorder, life_board *board)
+{
+    s32 slot = -1;
+    bool32 stalled = false;
+    pthread_mutex_lock(&recorder->mutex);
+    for(;;)
+    {
+        for(u32 slot_index = 0;
+            slot_index < LINUX_RECORD_SLOT_COUNT;
+            slot_index += 1)
+        {
+            if(recorder->slot_states[slot_index] == Linux_Slot_Free)
+            {
+                slot = (s32)slot_index;
+                break;
+            }
+        }
+        if(slot >= 0)
+        {
+            break;
+        }
+        if(!stalled)
+        {
+            recorder->stall_count += 1;
+            stalled = true;
+        }
+        pthread_cond_wait(&recorder->condition, &recorder->mutex);
+    }
+    recorder->slot_states[slot] = Linux_Slot_Filling;
+    pthread_mutex_unlock(&recorder->mutex);
+
+    copy_grid_snapshot(&board->grid, recorder->slots[slot]);
+    recorder->slot_generations[slot] = board->generation;
+
+    pthread_mutex_lock(&recorder->mutex);
+    recorder->slot_states[slot] = Linux_Slot_Ready;
+    recorder->ready_queue[recorder->ready_write % LINUX_RECORD_SLOT_COUNT] = (u32)slot;
+    recorder->ready_write += 1;
+    recorder->raw_bytes += recorder->word_count*sizeof(u64);
+    pthread_cond_broadcast(&recorder->condition);
+    pthread_mutex_unlock(&recorder->mutex);
+}
+
+internal bool32
+linux_stop_recorder(linux_recorder *recorder)
+{
+    pthread_mutex_lock(&recorder->mutex);
+    recorder->stopping = true;
+    pthread_cond_broadcast(&recorder->condition);
+    pthread_mutex_unlock(&recorder->mutex);
+    pthread_join(recorder->encoder_thread, 0);
+
+    linux_stop_writer(&recorder->writer);
+    bool32 result = !recorder->writer.failed;
+    if(fsync(recorder->writer.file) != 0)
+    {
+        result = false;
+    }
+    close(recorder->writer.file);
+    linux_free_record_slots(recorder);
+
+    printf("recorded %llu snapshots (%llu waits on the encoder), %.03f MB raw, %.03f MB written%s\n",
+           (unsigned long long)recorder->recorded_count,
+           (unsigned long long)recorder->stall_count,
+           (f64)recorder->raw_bytes / (1024.0*1024.0),
+           (f64)recorder->encoded_bytes / (1024.0*1024.0),
+           recorder->writer.use_io_uring ? " via io_uring" : "");
+    if(!result)
+    {
+        fprintf(stderr, "linux_life: writing the recording failed\n");
+    }
+    return(result);
+}
+
+// NOTE(ian): Reads a recording back (-D), checking that every snapshot
+// decodes and none are missing, and prints each one as a -P line. Births and
+// deaths are counted since the snapshot before, so with -n 1 the output is
+// the same as -P on the run that made the recording.
+internal bool32
+linux_verify_recording(const char *path, memory_arena *arena)
+{
+    u64 size = 0;
+    void *mapping = MAP_FAILED;
+    int file = open(path, O_RDONLY);
+    if(file >= 0)
+    {
+        struct stat status;
+        if(fstat(file, &status) == 0 && status.st_size > 0)
+        {
+            size = (u64)status.st_size;
+            mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        close(file);
+    }
+    if(mapping == MAP_FAILED)
+    {
+        fprintf(stderr, "linux_life: could not read %s: %s\n", path, strerror(errno));
+        return(false);
+    }
+
+    u8 *at = (u8 *)mapping;
+    u8 *end = at + size;
+    const char *error = 0;
+    u64 snapshot_count = 0;
+
+    life_record_header header = {};
+    if(size < sizeof(header))
+    {
+        error = "too short to be a recording";
+    }
+    else
+    {
+        memcpy(&header, at, sizeof(header));
+        at += sizeof(header);
+        if(header.magic != LIFE_RECORD_MAGIC || header.version != LIFE_RECORD_VERSION ||
+           header.interval == 0)
+        {
+            error = "not a recording";
+        }
+    }
+
+    if(!error)
+    {
+        temporary_memory verify_memory = begin_temporary_memory(arena);
+        u32 word_count = (header.columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+        u64 snapshot_word_count = get_snapshot_word_count(header.rows, header.columns);
+        u64 *words = Push_Array(arena, snapshot_word_count, u64, ARENA_ROW_ALIGNMENT);
+        u64 *previous = Push_Array(arena, snapshot_word_count, u64, ARENA_ROW_ALIGNMENT);
+
+        printf("generation\tpopulation\tbirths\tdeaths\tmin_row\tmin_column\tmax_row\tmax_column\n");
+        u64 next_generation = 0;
+        while(!error && at < end)
+        {
+            life_snapshot_header snapshot;
+            if((u64)(end - at) < sizeof(snapshot))
+            {
+                error = "snapshot header cut short";
+                break;
+            }
+            memcpy(&snapshot, at, sizeof(snapshot));
+            at += sizeof(snapshot);
+
+            bool32 keyframe = (snapshot.flags & Life_Snapshot_Keyframe);
+            if(snapshot.magic != LIFE_SNAPSHOT_MAGIC || snapshot.size > (u64)(end - at))
+            {
+                error = "bad snapshot header";
+            }
+            else if(!snapshot_count && !keyframe)
+            {
+                error = "first snapshot is not a keyframe";
+            }
+            else if(snapshot_count && snapshot.generation != next_generation)
+            {
+                error = "snapshots missing";
+            }
+            else if(!decode_snapshot(at, snapshot.size, keyframe, words, snapshot_word_count))
+            {
+                error = "snapshot does not decode";
+            }
+            else
+            {
+                life_stats stats;
+                clear_stats(&stats);
+                for(u32 row = 0;
+                    row < header.rows;
+                    row += 1)
+                {
+                    u64 offset = (u64)row*word_count;
+                    add_row_stats(&stats, row, words + offset, snapshot_count ? (previous + offset) : 0,
+                                  word_count, 0);
+                }
+                linux_print_stats(snapshot.generation, &stats);
+                memcpy(previous, words, snapshot_word_count*sizeof(u64));
+
+                at += snapshot.size;
+                next_generation = snapshot.generation + header.interval;
+                snapshot_count += 1;
+            }
+        }
+        end_temporary_memory(verify_memory);
+    }
+
+    munmap(mapping, size);
+    if(error)
+    {
+        fprintf(stderr, "linux_life: %s: %s after %llu snapshots\n",
+                path, error, (unsigned long long)snapshot_count);
+    }
+    else
+    {
+        printf("%llu snapshots of %ux%u, every %u generations\n",
+               (unsigned long long)snapshot_count, header.rows, header.columns, header.interval);
+    }
+    return(!error);
+}
@@ -0,0 +1,151 @@
+// NOTE(ian): Headless playback of input logs recorded at the window (see
+// game_input_log.h). Every frame goes back through game_update_and_render
+// exactly as it did live, so a session that stuttered can be run here as often
+// as we like, under a profiler or with -v to watch it, and the slow frame
+// picked out by number.
+//
+// Only the game's own frame is timed: not reading the log, and not the
+// capture, which waits on its writer thread.
+
+#include <sys/stat.h>
+
+internal int
+linux_compare_frame_times(const void *a, const void *b)
+{
+    f32 time_a = *(f32 *)a;
+    f32 time_b = *(f32 *)b;
+    int result = (time_a < time_b) ? -1 : (time_a > time_b) ? 1 : 0;
+    return(result);
+}
+
+internal u8 *
+linux_read_entire_file(const char *path, memory_arena *arena, u64 *size)
+{
+    u8 *result = 0;
+    int file = open(path, O_RDONLY);
+    if(file >= 0)
+    {
+        struct stat status;
+        if(fstat(file, &status) == 0)
+        {
+            *size = (u64)status.st_size;
+            u8 *contents = (u8 *)Push_Size(arena, *size + 1);
+            u64 read_size = 0;
+            while(read_size < *size)
+            {
+                ssize_t bytes = read(file, contents + read_size, *size - read_size);
+                if(bytes < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if(bytes <= 0)
+                {
+                    break;
+                }
+                read_size += (u64)bytes;
+            }
+            if(read_size == *size)
+            {
+                contents[*size] = 0;
+                result = contents;
+            }
+        }
+        close(file);
+    }
+    if(!result)
+    {
+        fprintf(stderr, "linux_life: could not read %s: %s\n", path, strerror(errno));
+    }
+    return(result);
+}
+
+internal bool32
+linux_replay_input(const char *path, memory_arena *arena,
+                   game_graphics_buffer *buffer, linux_capture *capture)
+{
+    u64 size = 0;
+    u8 *log = linux_read_entire_file(path, arena, &size);
+    if(!log)
+    {
+        return(false);
+    }
+
+    game_input_log_header header;
+    if(size < sizeof(header))
+    {
+        fprintf(stderr, "linux_life: %s is not an input log\n", path);
+        return(false);
+    }
+    memcpy(&header, log, sizeof(header));
+    if(header.magic != GAME_INPUT_LOG_MAGIC || header.version != GAME_INPUT_LOG_VERSION ||
+       header.rule_size > size - sizeof(header))
+    {
+        fprintf(stderr, "linux_life: %s is not an input log\n", path);
+        return(false);
+    }
+
+    char *rule_text = (char *)Push_Size(arena, header.rule_size + 1);
+    memcpy(rule_text, log + sizeof(header), header.rule_size);
+    rule_text[header.rule_size] = 0;
+
+    game_memory game = {};
+    game.is_initialized = false;
+    game.rule = header.rule_size ? rule_text : 0;
+
+    game_input inputs[2] = {};
+    game_input *old_input = &inputs[0];
+    game_input *new_input = &inputs[1];
+    set_input_buttons(old_input, header.old_buttons);
+
+    // NOTE(ian): Every frame is at least a byte, so this is always enough.
+    u8 *at = log + sizeof(header) + header.rule_size;
+    u8 *end = log + size;
+    f32 *frame_times = Push_Array(arena, end - at + 1, f32);
+    u64 frame_count = 0;
+    f32 slowest_time = 0.0f;
+    u64 slowest_frame = 0;
+
+    while(global_running && (at = decode_input_frame(at, end, new_input)) != 0)
+    {
+        timespec start = linux_get_wall_clock();
+        game_run_frame(buffer, &game, new_input, old_input);
+        timespec finish = linux_get_wall_clock();
+
+        f32 frame_time = linux_get_seconds_elapsed(start, finish);
+        if(frame_time > slowest_time)
+        {
+            slowest_time = frame_time;
+            slowest_frame = frame_count;
+        }
+        frame_times[frame_count++] = frame_time;
+
+        if(capture)
+        {
+            linux_capture_frame(capture, buffer);
+        }
+    }
+
+    if(frame_count == 0)
+    {
+        printf("%s: no frames\n", path);
+        return(true);
+    }
+
+    f32 total_time = 0.0f;
+    for(u64 frame = 0;
+        frame < frame_count;
+        frame += 1)
+    {
+        total_time += frame_times[frame];
+    }
+    qsort(frame_times, frame_count, sizeof(f32), linux_compare_frame_times);
+    f32 median_time = frame_times[frame_count / 2];
+    f32 tail_time = frame_times[(frame_count*99) / 100];
+
+    printf("%s: %llu frames in %.03fs\n", path, (unsigned long long)frame_count, total_time);
+    printf("  mean %.03fms, median %.03fms, 99th percentile %.03fms\n",
+           1000.0f*total_time / (f32)frame_count, 1000.0f*median_time, 1000.0f*tail_time);
+    printf("  slowest frame %llu at %.03fms\n", (unsigned long long)slowest_frame,
+           1000.0f*slowest_time);
+    return(true);
+}
@@ -0,0 +1,426 @@
+// NOTE(ian): Out-of-core stepping for boards that don't fit in memory. The
+// board lives in a grid file (see life_grid_file_header) and each generation
+// is written to a second file. We walk the board a stripe of rows at a time:
+// the source stripe (plus one row either side) is mapped read-only, the
+// destination stripe is mapped shared, and step_row slides its three-row
+// window down the stripe.
+//
+// The I/O overlaps the stepping without any extra threads: before we step a
+// stripe we ask the kernel to start reading the next one
+// (POSIX_FADV_WILLNEED), and once a stripe is written we kick off its
+// writeback (sync_file_range) and move on. Two stripes back we wait for that
+// writeback and drop both files' pages from the page cache, so the resident
+// set stays at a couple of stripes no matter how big the board is.
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+
+struct linux_grid_file
+{
+    int handle;
+    life_grid_file_header header;
+    u64 row_bytes;
+};
+
+struct linux_row_mapping
+{
+    void *mapping;
+    u64 mapping_size;
+    u8 *rows;
+};
+
+struct linux_stream_stripe
+{
+    linux_grid_file *source;
+    u8 *source_rows;      // NOTE(ian): row source_first_row of the source file
+    u32 source_first_row;
+    u8 *dest_rows;        // NOTE(ian): row first_row of the destination file
+    u32 first_row;
+    u32 end_row;
+    u64 *zero_row;
+};
+
+inline u64
+linux_get_row_offset(linux_grid_file *file, u32 row)
+{
+    u64 result = file->header.header_size + (u64)row*file->row_bytes;
+    return(result);
+}
+
+internal bool32
+linux_open_grid_file(linux_grid_file *file, const char *path)
+{
+    bool32 result = false;
+    file->handle = open(path, O_RDONLY);
+    if(file->handle >= 0)
+    {
+        if(pread(file->handle, &file->header, sizeof(file->header), 0) == sizeof(file->header) &&
+           file->header.magic == LIFE_GRID_FILE_MAGIC &&
+           file->header.version == LIFE_GRID_FILE_VERSION &&
+           file->header.words_per_row == get_words_per_row(file->header.columns) &&
+           (file->header.header_size % global_page_size) == 0)
+        {
+            file->row_bytes = (u64)file->header.words_per_row*sizeof(u64);
+            result = true;
+        }
+        else
+        {
+            fprintf(stderr, "linux_life: %s is not a grid file\n", path);
+            close(file->handle);
+        }
+    }
+    else
+    {
+        fprintf(stderr, "linux_life: could not open %s: %s\n", path, strerror(errno));
+    }
+    return(result);
+}
+
+internal bool32
+linux_create_grid_file(linux_grid_file *file, const char *path,
+                       u32 rows, u32 columns, u64 generation)
+{
+    bool32 result = false;
+
+    file->header = {};
+    file->header.magic = LIFE_GRID_FILE_MAGIC;
+    file->header.version = LIFE_GRID_FILE_VERSION;
+    file->header.rows = rows;
+    file->header.columns = columns;
+    file->header.words_per_row = get_words_per_row(columns);
+    file->header.header_size = (u32)LIFE_GRID_FILE_HEADER_SIZE;
+    file->header.generation = generation;
+    file->row_bytes = (u64)file->header.words_per_row*sizeof(u64);
+
+    file->handle = open(path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+    if(file->handle >= 0)
+    {
+        // NOTE(ian): The rows start out as a hole, so a fresh file costs no
+        // disk until the stepper writes it.
+        u64 file_size = linux_get_row_offset(file, rows);
+        life_grid_file_header header = file->header;
+        if(ftruncate(file->handle, (off_t)file_size) == 0 &&
+           pwrite(file->handle, &header, sizeof(header), 0) == sizeof(header))
+        {
+            result = true;
+        }
+        else
+        {
+            fprintf(stderr, "linux_life: could not size %s: %s\n", path, strerror(errno));
+            close(file->handle);
+        }
+    }
+    else
+    {
+        fprintf(stderr, "linux_life: could not create %s: %s\n", path, strerror(errno));
+    }
+    return(result);
+}
+
+internal bool32
+linux_map_rows(linux_row_mapping *mapping, linux_grid_file *file,
+               u32 first_row, u32 end_row, bool32 writable)
+{
+    u64 offset = linux_get_row_offset(file, first_row);
+    u64 aligned_offset = offset & ~(global_page_size - 1);
+    mapping->mapping_size = linux_get_row_offset(file, end_row) - aligned_offset;
+
+    int protection = writable ? (PROT_READ|PROT_WRITE) : PROT_READ;
+    mapping->mapping = mmap(0, mapping->mapping_size, protection, MAP_SHARED,
+                            file->handle, (off_t)aligned_offset);
+    bool32 result = (mapping->mapping != MAP_FAILED);
+    if(result)
+    {
+        mapping->rows = (u8 *)mapping->mapping + (offset - aligned_offset);
+        if(!writable)
+        {
+            madvise(mapping->mapping, mapping->mapping_size, MADV_SEQUENTIAL);
+        }
+    }
+    return(result);
+}
+
+internal void
+linux_unmap_rows(linux_row_mapping *mapping)
+{
+    munmap(mapping->mapping, mapping->mapping_size);
+}
+
+// NOTE(ian): Tells the kernel we're done with rows [first_row, end_row) of
+// a file. For a file we wrote, waits for the writeback we started earlier
+// first, since dirty pages can't be dropped.
+internal void
+linux_release_rows(linux_grid_file *file, u32 first_row, u32 end_row, bool32 written)
+{
+    if(first_row < end_row)
+    {
+        u64 offset = linux_get_row_offset(file, first_row);
+        u64 size = linux_get_row_offset(file, end_row) - offset;
+        if(written)
+        {
+            sync_file_range(file->handle, (off64_t)offset, (off64_t)size,
+                            SYNC_FILE_RANGE_WAIT_BEFORE|SYNC_FILE_RANGE_WRITE|SYNC_FILE_RANGE_WAIT_AFTER);
+        }
+        posix_fadvise(file->handle, (off_t)offset, (off_t)size, POSIX_FADV_DONTNEED);
+    }
+}
+
+internal
+PLATFORM_WORK_CALLBACK(linux_stream_stripe_work)
+{
+    linux_stream_stripe *stripe = (linux_stream_stripe *)data;
+    linux_grid_file *source = stripe->source;
+    u32 rows = source->header.rows;
+    u32 word_count = (source->header.columns + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+    u64 last_word_mask = get_last_word_mask(source->header.columns);
+
+    u32 worker_count = global_platform.worker_count;
+    u32 stripe_rows = stripe->end_row - stripe->first_row;
+    u32 rows_per_worker = (stripe_rows + worker_count - 1) / worker_count;
+    u32 first_row = stripe->first_row + worker_index*rows_per_worker;
+    u32 end_row = first_row + rows_per_worker;
+    if(end_row > stripe->end_row)
+    {
+        end_row = stripe->end_row;
+    }
+
+    for(u32 row = first_row;
+        row < end_row;
+        row += 1)
+    {
+        u64 *above = stripe->zero_row;
+        u64 *center = (u64 *)(stripe->source_rows + (row - stripe->source_first_row)*source->row_bytes);
+        u64 *below = stripe->zero_row;
+        if(row > 0)
+        {
+            above = (u64 *)((u8 *)center - source->row_bytes);
+        }
+        if(row + 1 < rows)
+        {
+            below = (u64 *)((u8 *)center + source->row_bytes);
+        }
+        u64 *result = (u64 *)(stripe->dest_rows + (row - stripe->first_row)*source->row_bytes);
+        step_row(above, center, below, result, word_count, last_word_mask);
+    }
+}
+
+internal bool32
+linux_stream_generation(linux_grid_file *source, linux_grid_file *dest,
+                        u32 stripe_rows, u64 *zero_row)
+{
+    bool32 result = true;
+    u32 rows = source->header.rows;
+
+    u32 stripe_index = 0;
+    for(u32 first_row = 0;
+        result && first_row < rows;
+        first_row += stripe_rows, stripe_index += 1)
+    {
+        u32 end_row = (first_row + stripe_rows < rows) ? (first_row + stripe_rows) : rows;
+        u32 source_first_row = (first_row > 0) ? (first_row - 1) : 0;
+        u32 source_end_row = (end_row < rows) ? (end_row + 1) : rows;
+
+        // NOTE(ian): Read-ahead for the stripe after this one.
+        if(end_row < rows)
+        {
+            u32 next_end_row = (end_row + stripe_rows + 1 < rows) ? (end_row + stripe_rows + 1) : rows;
+            u64 offset = linux_get_row_offset(source, end_row);
+            posix_fadvise(source->handle, (off_t)offset,
+                          (off_t)(linux_get_row_offset(source, next_end_row) - offset),
+                          POSIX_FADV_WILLNEED);
+        }
+
+        linux_row_mapping source_mapping;
+        linux_row_mapping dest_mapping;
+        if(linux_map_rows(&source_mapping, source, source_first_row, source_end_row, false))
+        {
+            if(linux_map_rows(&dest_mapping, dest, first_row, end_row, true))
+            {
+                linux_stream_stripe stripe = {};
+                stripe.source = source;
+                stripe.source_rows = source_mapping.rows;
+                stripe.source_first_row = source_first_row;
+                stripe.dest_rows = dest_mapping.rows;
+                stripe.first_row = first_row;
+                stripe.end_row = end_row;
+                stripe.zero_row = zero_row;
+                global_platform.run_on_workers(linux_stream_stripe_work, &stripe);
+
+                linux_unmap_rows(&dest_mapping);
+
+                // NOTE(ian): Write-behind: start writing this stripe out now,
+                // and don't wait for it until two stripes from now.
+                u64 offset = linux_get_row_offset(dest, first_row);
+                sync_file_range(dest->handle, (off64_t)offset,
+                                (off64_t)(linux_get_row_offset(dest, end_row) - offset),
+                                SYNC_FILE_RANGE_WRITE);
+            }
+            else
+            {
+                fprintf(stderr, "linux_life: could not map destination rows: %s\n", strerror(errno));
+                result = false;
+            }
+            linux_unmap_rows(&source_mapping);
+        }
+        else
+        {
+            fprintf(stderr, "linux_life: could not map source rows: %s\n", strerror(errno));
+            result = false;
+        }
+
+        if(stripe_index >= 2)
+        {
+            // NOTE(ian): The stripe two back is finished with for good: the
+            // next stripe's window starts at end_row - 1 of this one.
+            u32 old_first_row = first_row - 2*stripe_rows;
+            u32 old_end_row = first_row - stripe_rows;
+            linux_release_rows(dest, old_first_row, old_end_row, true);
+            linux_release_rows(source, old_first_row, old_end_row - 1, false);
+        }
+    }
+
+    return(result);
+}
+
+internal bool32
+linux_stream_board(memory_arena *arena, const char *source_path, const char *dest_path,
+                   int generation_count, u64 stripe_bytes)
+{
+    bool32 result = false;
+
+    // NOTE(ian): dest_path only ever gets a stepped generation, so with none
+    // to run there'd be nothing to put there.
+    if(generation_count < 1)
+    {
+        fprintf(stderr, "linux_life: -f needs at least one generation\n");
+        return(false);
+    }
+
+    linux_grid_file files[2];
+    if(linux_open_grid_file(&files[0], source_path))
+    {
+        life_grid_file_header header = files[0].header;
+
+        // NOTE(ian): Generations ping-pong between dest_path and a scratch
+        // file next to it, and the last one is renamed to dest_path. The
+        // source file is never written.
+        char swap_path[4096];
+        snprintf(swap_path, sizeof(swap_path), "%s.swap", dest_path);
+        const char *paths[2] = {dest_path, swap_path};
+
+        u32 stripe_rows = (u32)(stripe_bytes / files[0].row_bytes);
+        if(stripe_rows < 1)
+        {
+            stripe_rows = 1;
+        }
+
+        temporary_memory stream_memory = begin_temporary_memory(arena);
+        u64 *zero_row = Push_Array(arena, header.words_per_row, u64, ARENA_ROW_ALIGNMENT);
+        memset(zero_row, 0, header.words_per_row*sizeof(u64));
+
+        timespec start = linux_get_wall_clock();
+        linux_grid_file *source = &files[0];
+        const char *last_path = 0;
+        result = true;
+        for(int generation = 0;
+            result && global_running && generation < generation_count;
+            generation += 1)
+        {
+            linux_grid_file *dest = &files[1];
+            const char *path = paths[generation & 1];
+            if(linux_create_grid_file(dest, path, header.rows, header.columns,
+                                      source->header.generation + 1))
+            {
+                result = linux_stream_generation(source, dest, stripe_rows, zero_row);
+                linux_release_rows(dest, 0, header.rows, true);
+                linux_release_rows(source, 0, header.rows, false);
+
+                close(source->handle);
+                files[0] = files[1];
+                last_path = path;
+            }
+            else
+            {
+                result = false;
+            }
+        }
+        if(result && last_path && fdatasync(source->handle) != 0)
+        {
+            fprintf(stderr, "linux_life: could not write %s: %s\n", last_path, strerror(errno));
+            result = false;
+        }
+        close(source->handle);
+        timespec end = linux_get_wall_clock();
+
+        if(result && last_path && last_path != dest_path && rename(last_path, dest_path) != 0)
+        {
+            fprintf(stderr, "linux_life: could not rename %s to %s: %s\n",
+                    last_path, dest_path, strerror(errno));
+            result = false;
+        }
+        if(!result)
+        {
+            // NOTE(ian): Whatever is at dest_path is half a generation or an
+            // old one, and either way not the answer.
+            unlink(dest_path);
+        }
+        unlink(swap_path);
+        end_temporary_memory(stream_memory);
+
+        f32 seconds_elapsed = linux_get_seconds_elapsed(start, end);
+        f64 bytes = (f64)linux_get_row_offset(&files[0], header.rows)*2.0*generation_count;
+        printf("streamed %ux%u board, %d generations in %.03fs, %.03f GB/s of I/O, %u rows per stripe\n",
+               header.rows, header.columns, generation_count, seconds_elapsed,
+               bytes / (seconds_elapsed * 1e9), stripe_rows);
+    }
+
+    return(result);
+}
+
+internal bool32
+linux_write_random_grid_file(const char *path, u32 rows, u32 columns, f32 density, u64 seed)
+{
+    linux_grid_file file;
+    bool32 result = linux_create_grid_file(&file, path, rows, columns, 0);
+    if(result)
+    {
+        // NOTE(ian): Written a chunk of rows at a time so this works for
+        // boards far bigger than memory too.
+        u32 chunk_rows = (u32)(Megabytes(16) / file.row_bytes);
+        if(chunk_rows < 1)
+        {
+            chunk_rows = 1;
+        }
+        u64 *chunk = (u64 *)calloc(chunk_rows, file.row_bytes);
+        u32 level = get_density_level(density);
+
+        for(u32 first_row = 0;
+            result && first_row < rows;
+            first_row += chunk_rows)
+        {
+            u32 end_row = (first_row + chunk_rows < rows) ? (first_row + chunk_rows) : rows;
+            for(u32 row = first_row;
+                row < end_row;
+                row += 1)
+            {
+                // NOTE(ian): Same soup as fill_board_random gives for the seed.
+                life_random random;
+                seed_row_random(&random, seed, row);
+                fill_row_random(chunk + (u64)(row - first_row)*file.header.words_per_row,
+                                0, columns, level, &random);
+            }
+
+            u64 size = (u64)(end_row - first_row)*file.row_bytes;
+            if(pwrite(file.handle, chunk, size, (off_t)linux_get_row_offset(&file, first_row)) != (ssize_t)size)
+            {
+                fprintf(stderr, "linux_life: could not write %s: %s\n", path, strerror(errno));
+                result = false;
+            }
+        }
+
+        free(chunk);
+        close(file.handle);
+    }
+    return(result);
+}
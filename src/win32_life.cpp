@@ -1,5 +1,7 @@
 #include "cross_platform.h"
-// #include "game_of_life.h"
+#include "gol.h"
+#include "game_of_life.h"
+#include "game_input_log.h"
 
 #include <windows.h>
 #include <stdio.h>
@@ -25,6 +27,7 @@ struct win32_graphics_buffer
 
 global_variable bool global_running;
 global_variable bool global_pause;
+global_variable bool32 global_toggle_recording;
 
 // TODO(ian): i would love this to NOT be a global, but presently it
 // seems like it must be so, because Windows can call us in the callback...
@@ -51,6 +54,152 @@ win32_get_seconds_elapsed(s64 perf_counter_frequency,
 }
 
 
+#define WIN32_MAX_WORKERS 64
+
+struct win32_worker_pool
+{
+    // NOTE(ian): job_lock is held for a whole win32_run_on_workers, so two
+    // threads stepping different boards take turns instead of clobbering
+    // each other's job; lock guards the fields below.
+    CRITICAL_SECTION job_lock;
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE start_condition;
+    CONDITION_VARIABLE done_condition;
+
+    u32 job_index;
+    u32 pending_count;
+    platform_work_callback *callback;
+    void *data;
+
+    u32 worker_count;
+    u32 node_count;
+    u32 worker_cpus[WIN32_MAX_WORKERS];
+};
+
+global_variable win32_worker_pool global_worker_pool;
+
+internal void
+win32_get_worker_topology(win32_worker_pool *pool)
+{
+    // NOTE(ian): Only looks at processor group 0, which is every core on
+    // anything with 64 or fewer logical processors. Workers are numbered node
+    // by node so neighbouring bands of the grid end up on the same socket.
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask);
+
+    ULONG highest_node = 0;
+    GetNumaHighestNodeNumber(&highest_node);
+
+    pool->worker_count = 0;
+    pool->node_count = 0;
+    for(ULONG node = 0;
+        node <= highest_node;
+        node += 1)
+    {
+        ULONGLONG node_mask = 0;
+        if(GetNumaNodeProcessorMask((UCHAR)node, &node_mask))
+        {
+            node_mask &= (ULONGLONG)process_mask;
+            if(node_mask)
+            {
+                pool->node_count += 1;
+            }
+            for(u32 cpu = 0;
+                cpu < WIN32_MAX_WORKERS;
+                cpu += 1)
+            {
+                if(node_mask & (1ULL << cpu))
+                {
+                    pool->worker_cpus[pool->worker_count++] = cpu;
+                }
+            }
+        }
+    }
+
+    if(pool->worker_count == 0)
+    {
+        pool->worker_count = 1;
+        pool->node_count = 1;
+        pool->worker_cpus[0] = 0;
+    }
+}
+
+internal DWORD WINAPI
+win32_worker_thread_proc(LPVOID parameter)
+{
+    win32_worker_pool *pool = &global_worker_pool;
+    u32 worker_index = (u32)(u64)parameter;
+
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << pool->worker_cpus[worker_index]);
+
+    u32 seen_job_index = 0;
+    for(;;)
+    {
+        EnterCriticalSection(&pool->lock);
+        while(pool->job_index == seen_job_index)
+        {
+            SleepConditionVariableCS(&pool->start_condition, &pool->lock, INFINITE);
+        }
+        seen_job_index = pool->job_index;
+        platform_work_callback *callback = pool->callback;
+        void *data = pool->data;
+        LeaveCriticalSection(&pool->lock);
+
+        callback(worker_index, data);
+
+        EnterCriticalSection(&pool->lock);
+        pool->pending_count -= 1;
+        if(pool->pending_count == 0)
+        {
+            WakeConditionVariable(&pool->done_condition);
+        }
+        LeaveCriticalSection(&pool->lock);
+    }
+}
+
+internal
+PLATFORM_RUN_ON_WORKERS(win32_run_on_workers)
+{
+    win32_worker_pool *pool = &global_worker_pool;
+
+    EnterCriticalSection(&pool->job_lock);
+    EnterCriticalSection(&pool->lock);
+    pool->callback = callback;
+    pool->data = data;
+    pool->pending_count = pool->worker_count;
+    pool->job_index += 1;
+    WakeAllConditionVariable(&pool->start_condition);
+    while(pool->pending_count)
+    {
+        SleepConditionVariableCS(&pool->done_condition, &pool->lock, INFINITE);
+    }
+    LeaveCriticalSection(&pool->lock);
+    LeaveCriticalSection(&pool->job_lock);
+}
+
+internal void
+win32_start_workers(win32_worker_pool *pool)
+{
+    InitializeCriticalSection(&pool->job_lock);
+    InitializeCriticalSection(&pool->lock);
+    InitializeConditionVariable(&pool->start_condition);
+    InitializeConditionVariable(&pool->done_condition);
+    pool->job_index = 0;
+    pool->pending_count = 0;
+
+    win32_get_worker_topology(pool);
+    for(u32 worker_index = 0;
+        worker_index < pool->worker_count;
+        worker_index += 1)
+    {
+        DWORD thread_id;
+        HANDLE thread = CreateThread(0, 0, win32_worker_thread_proc,
+                                     (LPVOID)(u64)worker_index, 0, &thread_id);
+        CloseHandle(thread);
+    }
+}
+
 internal win32_window_dimension
 win32_get_window_dimension(HWND window)
 {
@@ -96,6 +245,90 @@ toggle_fullscreen(HWND Window)
     }
 }
 
+// NOTE(ian): L starts writing every frame's input to the log, on a fresh
+// board, and L again stops. linux_life -I plays a log back. Start with the
+// mouse up: the game remembers where a drag began, and that isn't in the log.
+#define WIN32_INPUT_LOG_PATH "game_of_life_input.log"
+
+struct win32_input_recorder
+{
+    HANDLE file;
+    game_input previous;
+};
+
+internal bool32
+win32_write_log(win32_input_recorder *recorder, void *memory, DWORD size)
+{
+    DWORD bytes_written = 0;
+    bool32 result = (WriteFile(recorder->file, memory, size, &bytes_written, 0) &&
+                     bytes_written == size);
+    return(result);
+}
+
+// NOTE(ian): Recording is started and stopped by hotkey with nothing else on
+// screen, so failures go to the debugger like the rest of our chatter.
+internal void
+win32_report_input_log_error(const char *message, const char *path)
+{
+    char debug_str[256];
+    _snprintf_s(debug_str, sizeof(debug_str), "%s %s (error %lu)\n",
+                message, path, (unsigned long)GetLastError());
+    OutputDebugStringA(debug_str);
+}
+
+internal void
+win32_end_input_recording(win32_input_recorder *recorder)
+{
+    CloseHandle(recorder->file);
+    recorder->file = 0;
+}
+
+internal bool32
+win32_begin_input_recording(win32_input_recorder *recorder, const char *path,
+                            game_memory *memory, game_input *old_input)
+{
+    bool32 result = false;
+    recorder->file = CreateFileA(path, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, 0, 0);
+    if(recorder->file != INVALID_HANDLE_VALUE)
+    {
+        game_input_log_header header = {};
+        header.magic = GAME_INPUT_LOG_MAGIC;
+        header.version = GAME_INPUT_LOG_VERSION;
+        header.rule_size = memory->rule ? (u32)strlen(memory->rule) : 0;
+        header.old_buttons = get_input_buttons(old_input);
+        recorder->previous = {};
+        if(win32_write_log(recorder, &header, sizeof(header)) &&
+           win32_write_log(recorder, memory->rule, header.rule_size))
+        {
+            result = true;
+        }
+        else
+        {
+            win32_report_input_log_error("Couldn't write the header of", path);
+            win32_end_input_recording(recorder);
+        }
+    }
+    else
+    {
+        win32_report_input_log_error("Couldn't create", path);
+        recorder->file = 0;
+    }
+    return(result);
+}
+
+internal void
+win32_record_input(win32_input_recorder *recorder, game_input *input)
+{
+    u8 frame[GAME_INPUT_LOG_MAX_FRAME_SIZE];
+    u8 *frame_end = encode_input_frame(frame, input, &recorder->previous);
+    recorder->previous = *input;
+    if(!win32_write_log(recorder, frame, (DWORD)(frame_end - frame)))
+    {
+        win32_report_input_log_error("Recording stopped, couldn't write to", WIN32_INPUT_LOG_PATH);
+        win32_end_input_recording(recorder);
+    }
+}
+
 internal bool32
 update_input_state(bool32 current_input, bool32 is_down)
 {
@@ -171,6 +404,13 @@ win32_process_pending_messages(game_input *new_input)
                             global_pause = !global_pause;
                         }
                     }
+                    if(vk_code == 'L')
+                    {
+                        if(is_down)
+                        {
+                            global_toggle_recording = true;
+                        }
+                    }
                     if(vk_code == VK_SPACE)
                     {
                         if(is_down)
@@ -380,23 +620,15 @@ WinMain(HINSTANCE Instance,
                 global_win32_graphics_buffer.win32_dib_info.bmiHeader.biCompression = BI_RGB;
             }
 
-// NOTE(ian): If we're doing a debug-build, then we want to have a consistent
-// base address for our memory block, which will make debugging easier.
-#if GOL_DEBUG
-            LPVOID base_address = (LPVOID)Terabytes(2);
-#else
-            LPVOID base_address = 0;
-#endif
+            // NOTE(ian): libgol brings its own memory; all it needs from us
+            // is the worker pool.
+            win32_start_workers(&global_worker_pool);
+            gol_set_workers(global_worker_pool.worker_count, win32_run_on_workers);
 
-            // ALLOCATE GAME MEMORY
             game_memory memory    = {};
             memory.is_initialized = false;
-            memory.storage_size   = Megabytes(64);
-            memory.used           = 0;
-            memory.storage_memory = VirtualAlloc(base_address,
-                                                 (size_t)memory.storage_size,
-                                                 MEM_RESERVE|MEM_COMMIT,
-                                                 PAGE_READWRITE);
+
+            win32_input_recorder recorder = {};
 
             game_input inputs[2] = {};
             game_input *old_input = &inputs[0]; // input for the previous frame
@@ -457,20 +689,26 @@ WinMain(HINSTANCE Instance,
                     graphics_buffer.bytes_per_pixel = global_win32_graphics_buffer.bytes_per_pixel;
 
 
-                    if(new_input->reset)
+                    if(global_toggle_recording)
                     {
-                        memory.is_initialized = false;
-                        memory.used           = 0;
+                        global_toggle_recording = false;
+                        if(recorder.file)
+                        {
+                            win32_end_input_recording(&recorder);
+                        }
+                        else if(win32_begin_input_recording(&recorder, WIN32_INPUT_LOG_PATH,
+                                                            &memory, old_input))
+                        {
+                            memory.is_initialized = false;
+                        }
                     }
-                    game_update_and_render(&graphics_buffer, &memory, *new_input, *old_input);
-
-                    for(int i = 0;
-                        i < Array_Count(new_input->button_states);
-                        i += 1)
+                    if(recorder.file)
                     {
-                        old_input->button_states[i] = new_input->button_states[i];
+                        win32_record_input(&recorder, new_input);
                     }
 
+                    game_run_frame(&graphics_buffer, &memory, new_input, old_input);
+
 #if 0
 
                     char debug_input_str[256];